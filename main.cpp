@@ -1,46 +1,35 @@
-#include <clang/AST/ASTConsumer.h>
-#include <clang/AST/ASTContext.h>
-#include <clang/AST/Decl.h>
-#include <clang/AST/DeclBase.h>
-#include <clang/AST/DeclCXX.h>
-#include <clang/Frontend/CompilerInstance.h>
-#include <clang/Frontend/FrontendAction.h>
 #include <clang/Tooling/CompilationDatabase.h>
 #include <clang/Tooling/Tooling.h>
 #include <llvm/ADT/StringRef.h>
-#include <llvm/Support/Casting.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
 #include <llvm/Support/FormatVariadic.h>
 #include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "typedb.h"
+#include "typedb_api.h"
+#include "typedb_binary.h"
 #include "typedb_builder.h"
+#include "typedb_cpp.h"
+#include "typedb_interner.h"
+#include "typedb_io.h"
 #include "typedb_json.h"
+#include "typedb_metrics.h"
+#include "typedb_pipeline.h"
+#include "typedb_plan.h"
+#include "typedb_size_report.h"
 
 using namespace clang;
 using namespace clang::tooling;
 
-namespace me3::typedb {
-class TypeDbAstConsumer : public ASTConsumer {
-public:
-  void HandleTranslationUnit(ASTContext &ctx) override {
-    TypeDb const m = build_type_db(ctx);
-    llvm::outs() << llvm::formatv("{0:2}\n", typedb_to_json(m));
-  }
-};
-
-class CreateTypeDbAction : public ASTFrontendAction {
-public:
-  auto CreateASTConsumer(CompilerInstance & /*CI*/, llvm::StringRef /*InFile*/)
-      -> std::unique_ptr<ASTConsumer> override {
-    return std::make_unique<TypeDbAstConsumer>();
-  }
-};
-} // namespace me3::typedb
-
 static llvm::cl::OptionCategory CLI_CATEGORY("dump-layouts options");
 
 static llvm::cl::list<std::string> CLI_EXTRA_ARGS(
@@ -48,25 +37,402 @@ static llvm::cl::list<std::string> CLI_EXTRA_ARGS(
     llvm::cl::desc("Additional compile argument (can be repeated)"),
     llvm::cl::ZeroOrMore, llvm::cl::cat(CLI_CATEGORY));
 
+static llvm::cl::opt<bool> CLI_SKIP_SYSTEM_HEADERS(
+    "skip-system-headers",
+    llvm::cl::desc("Do not traverse declarations in system headers; types "
+                   "they define are still emitted when referenced"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::list<std::string> CLI_ALLOW_PATHS(
+    "allow-path",
+    llvm::cl::desc("Only traverse declarations in files under this "
+                   "directory or file (can be repeated)"),
+    llvm::cl::ZeroOrMore, llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::list<std::string> CLI_DENY_PATHS(
+    "deny-path",
+    llvm::cl::desc("Never traverse declarations in files under this "
+                   "directory or file (can be repeated)"),
+    llvm::cl::ZeroOrMore, llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_JOBS(
+    "jobs",
+    llvm::cl::desc("Number of parser threads; bounds the number of ASTs held "
+                   "in memory at once"),
+    llvm::cl::init(1), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_QUEUE_DEPTH(
+    "queue-depth",
+    llvm::cl::desc("Number of finished type databases, beyond one per "
+                   "parser, that may wait for the serializer before parsers "
+                   "block"),
+    llvm::cl::init(1), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_LAYOUT_THREADS(
+    "layout-threads",
+    llvm::cl::desc("Build record layouts of a single translation unit on "
+                   "this many threads"),
+    llvm::cl::init(1), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_MERGE(
+    "merge",
+    llvm::cl::desc("Merge the type databases of all sources into one output"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_OUTPUT(
+    "o", llvm::cl::desc("Output file (default: stdout)"),
+    llvm::cl::value_desc("path"), llvm::cl::init("-"),
+    llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<me3::typedb::Compression> CLI_COMPRESS(
+    "compress", llvm::cl::desc("Compress the output stream"),
+    llvm::cl::values(
+        clEnumValN(me3::typedb::Compression::None, "none", "No compression"),
+        clEnumValN(me3::typedb::Compression::Zstd, "zstd",
+                   "Multi-threaded zstd frame")),
+    llvm::cl::init(me3::typedb::Compression::None),
+    llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<int> CLI_COMPRESS_LEVEL(
+    "compress-level", llvm::cl::desc("zstd compression level"),
+    llvm::cl::init(3), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_COMPRESS_THREADS(
+    "compress-threads",
+    llvm::cl::desc("zstd worker threads (0: one per hardware thread)"),
+    llvm::cl::init(0), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_FAST(
+    "fast",
+    llvm::cl::desc("Skip function bodies and codegen-oriented flags; only "
+                   "declarations are parsed"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_VALIDATE_FAST(
+    "validate-fast",
+    llvm::cl::desc("With --fast, also run a full parse and fail if the "
+                   "databases differ"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_STREAM(
+    "stream",
+    llvm::cl::desc("Write nodes as soon as each record is built instead of "
+                   "holding the whole database in memory"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_LEGACY_SCHEMA(
+    "legacy-schema",
+    llvm::cl::desc("Emit schema 5.0.0 output with a cdecl on every "
+                   "non-record node"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_EMIT_CPP(
+    "emit-cpp",
+    llvm::cl::desc("Also write the merged layouts as a C++ header of "
+                   "constexpr offsets and packed structs"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_CPP_NAMESPACE(
+    "cpp-namespace",
+    llvm::cl::desc("Namespace of the declarations written by --emit-cpp"),
+    llvm::cl::init("me3::layout"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_EMIT_BINARY(
+    "emit-binary",
+    llvm::cl::desc("Also write the merged database in the uncompressed, "
+                   "memory-mappable binary format"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_SOURCES_FROM(
+    "sources-from",
+    llvm::cl::desc("Read additional source paths from a file, one per line"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_PLAN(
+    "plan",
+    llvm::cl::desc("Do not parse; split the sources into this many balanced "
+                   "shard manifests in --plan-dir"),
+    llvm::cl::init(0), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_PLAN_DIR(
+    "plan-dir",
+    llvm::cl::desc("Directory holding the shard manifests written by --plan "
+                   "and read by --shard"),
+    llvm::cl::value_desc("dir"), llvm::cl::init("."),
+    llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::list<std::string> CLI_PLAN_STATS(
+    "plan-stats",
+    llvm::cl::desc("Timings written by --stats used to price sources for "
+                   "--plan instead of their file size (can be repeated)"),
+    llvm::cl::value_desc("path"), llvm::cl::ZeroOrMore,
+    llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_SHARD(
+    "shard",
+    llvm::cl::desc("Parse the sources of manifest i of N from --plan-dir "
+                   "and write them as one merged partial database"),
+    llvm::cl::value_desc("i/N"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::list<std::string> CLI_MERGE_FROM(
+    "merge-from",
+    llvm::cl::desc("Merge a previously written database into the output "
+                   "(can be repeated); sources are optional"),
+    llvm::cl::value_desc("path"), llvm::cl::ZeroOrMore,
+    llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_STATS(
+    "stats",
+    llvm::cl::desc("Write the parse time of every source to this file"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_SIZE_REPORT(
+    "size-report",
+    llvm::cl::desc("Write node count, heap bytes and serialized bytes of "
+                   "the merged database per node kind and per top-level "
+                   "namespace"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<std::string> CLI_METRICS_FILE(
+    "metrics-file",
+    llvm::cl::desc("Periodically rewrite this file with build progress in "
+                   "Prometheus text format"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<bool> CLI_PROGRESS(
+    "progress",
+    llvm::cl::desc("Periodically print build progress to stderr"),
+    llvm::cl::init(false), llvm::cl::cat(CLI_CATEGORY));
+
+static llvm::cl::opt<unsigned> CLI_METRICS_INTERVAL(
+    "metrics-interval",
+    llvm::cl::desc("Seconds between --metrics-file and --progress reports"),
+    llvm::cl::init(10), llvm::cl::cat(CLI_CATEGORY));
+
+static auto write_plan(const std::vector<std::string> &Sources) -> int {
+  me3::typedb::SourceTimings Timings;
+  for (const std::string &StatsPath : CLI_PLAN_STATS) {
+    if (llvm::Error Err = me3::typedb::read_timings(StatsPath, Timings)) {
+      llvm::errs() << llvm::toString(std::move(Err)) << "\n";
+      return 1;
+    }
+  }
+  if (std::error_code Err =
+          llvm::sys::fs::create_directories(CLI_PLAN_DIR.getValue())) {
+    llvm::errs() << CLI_PLAN_DIR << ": " << Err.message() << "\n";
+    return 1;
+  }
+  std::vector<me3::typedb::Shard> const Shards = me3::typedb::plan_shards(
+      Sources, me3::typedb::estimate_costs(Sources, Timings), CLI_PLAN);
+  for (unsigned I = 0; I < Shards.size(); ++I) {
+    std::string const Path = me3::typedb::shard_manifest_path(
+        CLI_PLAN_DIR, I + 1, static_cast<unsigned>(Shards.size()));
+    if (llvm::Error Err = me3::typedb::write_shard_manifest(Path, Shards[I])) {
+      llvm::errs() << llvm::toString(std::move(Err)) << "\n";
+      return 1;
+    }
+    llvm::errs() << Path << ": " << Shards[I].sources.size()
+                 << " sources, estimated cost "
+                 << llvm::format("%.3f", Shards[I].cost) << "\n";
+  }
+  return 0;
+}
+
 auto main(int argc, const char **argv) -> int {
   namespace cl = llvm::cl;
-  cl::opt<std::string> const SourcePath(cl::Positional,
-                                        cl::desc("<source-file>"), cl::Required,
-                                        cl::cat(CLI_CATEGORY));
+  cl::list<std::string> const SourcePaths(
+      cl::Positional, cl::desc("<source-file>..."), cl::ZeroOrMore,
+      cl::cat(CLI_CATEGORY));
   cl::HideUnrelatedOptions(CLI_CATEGORY);
   if (cl::ParseCommandLineOptions(argc, argv, "Dump record layouts\n")) {
-    std::vector<std::string> CompileArgs = {
-        "-std=c++17", "--target=x86_64-pc-windows-msvc", "-O0", "-g"};
+    std::vector<std::string> CompileArgs = me3::typedb::default_compile_args(
+        CLI_FAST ? me3::typedb::ParseMode::Fast : me3::typedb::ParseMode::Full);
     CompileArgs.insert(CompileArgs.end(), CLI_EXTRA_ARGS.begin(),
                        CLI_EXTRA_ARGS.end());
 
     FixedCompilationDatabase const Compilations(".", CompileArgs);
 
-    std::vector<std::string> const Sources{SourcePath};
-    ClangTool Tool(Compilations, Sources);
+    std::vector<std::string> Sources(SourcePaths.begin(), SourcePaths.end());
+    if (!CLI_SOURCES_FROM.empty()) {
+      llvm::Expected<std::vector<std::string>> Listed =
+          me3::typedb::read_source_list(CLI_SOURCES_FROM);
+      if (!Listed) {
+        llvm::errs() << llvm::toString(Listed.takeError()) << "\n";
+        return 1;
+      }
+      Sources.insert(Sources.end(), Listed->begin(), Listed->end());
+    }
+    if (CLI_PLAN != 0) {
+      if (Sources.empty()) {
+        llvm::errs() << "no source files given\n";
+        return 1;
+      }
+      return write_plan(Sources);
+    }
+    if (!CLI_SHARD.empty()) {
+      unsigned ShardIndex = 0;
+      unsigned ShardCount = 0;
+      if (!me3::typedb::parse_shard_spec(CLI_SHARD, ShardIndex, ShardCount)) {
+        llvm::errs() << "--shard expects i/N with 1 <= i <= N\n";
+        return 1;
+      }
+      if (!Sources.empty()) {
+        llvm::errs() << "--shard takes its sources from the manifest\n";
+        return 1;
+      }
+      llvm::Expected<std::vector<std::string>> Listed =
+          me3::typedb::read_source_list(me3::typedb::shard_manifest_path(
+              CLI_PLAN_DIR, ShardIndex, ShardCount));
+      if (!Listed) {
+        llvm::errs() << llvm::toString(Listed.takeError()) << "\n";
+        return 1;
+      }
+      Sources = std::move(*Listed);
+    } else if (Sources.empty() && CLI_MERGE_FROM.empty()) {
+      llvm::errs() << "no source files given\n";
+      return 1;
+    }
+
+    me3::typedb::BuildOptions Options;
+    Options.skip_system_headers = CLI_SKIP_SYSTEM_HEADERS;
+    Options.allow_paths.assign(CLI_ALLOW_PATHS.begin(), CLI_ALLOW_PATHS.end());
+    Options.deny_paths.assign(CLI_DENY_PATHS.begin(), CLI_DENY_PATHS.end());
+    Options.layout_threads = CLI_LAYOUT_THREADS;
+    // Shared by every parse of this run.
+    me3::typedb::TypeIdInterner TypeIds;
+    Options.type_ids = &TypeIds;
+
+    me3::typedb::PipelineOptions Pipeline;
+    Pipeline.parse_jobs = CLI_JOBS;
+    Pipeline.queue_depth = CLI_QUEUE_DEPTH;
+    Pipeline.parse_mode = CLI_FAST ? me3::typedb::ParseMode::Fast
+                                   : me3::typedb::ParseMode::Full;
+    Pipeline.validate_fast = CLI_VALIDATE_FAST;
+
+    me3::typedb::OutputOptions OutOptions;
+    OutOptions.compression = CLI_COMPRESS;
+    OutOptions.level = CLI_COMPRESS_LEVEL;
+    OutOptions.threads = CLI_COMPRESS_THREADS;
+    llvm::Expected<std::unique_ptr<llvm::raw_ostream>> Out =
+        me3::typedb::open_output(CLI_OUTPUT, OutOptions);
+    if (!Out) {
+      llvm::errs() << llvm::toString(Out.takeError()) << "\n";
+      return 1;
+    }
+
+    me3::typedb::JsonOptions Json;
+    Json.legacy_schema = CLI_LEGACY_SCHEMA;
+
+    // Shards and merge inputs are always written as one merged database.
+    bool const MergeOutput =
+        CLI_MERGE || !CLI_SHARD.empty() || !CLI_MERGE_FROM.empty();
+    std::unique_ptr<me3::typedb::TypeDbJsonWriter> StreamWriter;
+    if (CLI_STREAM) {
+      if (MergeOutput || CLI_VALIDATE_FAST || Pipeline.parse_jobs > 1 ||
+          !CLI_EMIT_CPP.empty() || !CLI_EMIT_BINARY.empty() ||
+          !CLI_SIZE_REPORT.empty()) {
+        llvm::errs() << "--stream cannot be combined with --merge, "
+                        "--validate-fast, --emit-cpp, --emit-binary, "
+                        "--size-report or --jobs > 1\n";
+        return 1;
+      }
+      StreamWriter =
+          std::make_unique<me3::typedb::TypeDbJsonWriter>(**Out, Json);
+      Options.sink = StreamWriter.get();
+    }
+
+    bool const KeepMerged = MergeOutput || !CLI_EMIT_CPP.empty() ||
+                            !CLI_EMIT_BINARY.empty() ||
+                            !CLI_SIZE_REPORT.empty();
+    me3::typedb::TypeDb Merged;
+    for (const std::string &Partial : CLI_MERGE_FROM) {
+      llvm::Expected<me3::typedb::TypeDb> Loaded =
+          me3::typedb::load_typedb_file(Partial);
+      if (!Loaded) {
+        llvm::errs() << llvm::toString(Loaded.takeError()) << "\n";
+        return 1;
+      }
+      Merged.merge_from(std::move(*Loaded));
+    }
+
+    me3::typedb::PipelineMetrics Metrics;
+    std::unique_ptr<me3::typedb::MetricsReporter> Reporter;
+    if (!CLI_METRICS_FILE.empty() || CLI_PROGRESS) {
+      me3::typedb::MetricsReporterOptions ReporterOptions;
+      ReporterOptions.prometheus_path = CLI_METRICS_FILE;
+      ReporterOptions.progress = CLI_PROGRESS;
+      ReporterOptions.interval =
+          std::chrono::seconds(std::max(1U, CLI_METRICS_INTERVAL.getValue()));
+      Pipeline.metrics = &Metrics;
+      Reporter = std::make_unique<me3::typedb::MetricsReporter>(
+          Metrics, std::move(ReporterOptions));
+    }
 
-    return Tool.run(
-        newFrontendActionFactory<me3::typedb::CreateTypeDbAction>().get());
+    me3::typedb::SourceTimings Timings;
+    int Status = me3::typedb::run_pipeline(
+        Compilations, Sources, Options, Pipeline,
+        [&](me3::typedb::ParsedTypeDb &&Parsed) {
+          Timings[Parsed.source] = Parsed.parse_seconds;
+          if (CLI_STREAM) {
+            return;
+          }
+          if (!MergeOutput) {
+            **Out << llvm::formatv(
+                "{0:2}\n", me3::typedb::typedb_to_json(Parsed.db, Json));
+          }
+          if (KeepMerged) {
+            Merged.merge_from(std::move(Parsed.db));
+          }
+        });
+    Reporter.reset();
+    if (KeepMerged) {
+      // Complete from here on: the emitters below walk it one kind at a time.
+      Merged.columnize();
+      Merged.build_indices();
+    }
+    if (MergeOutput) {
+      **Out << llvm::formatv("{0:2}\n",
+                             me3::typedb::typedb_to_json(Merged, Json));
+    }
+    if (!CLI_STATS.empty()) {
+      std::error_code Err;
+      llvm::raw_fd_ostream StatsOut(CLI_STATS, Err, llvm::sys::fs::OF_Text);
+      if (Err) {
+        llvm::errs() << CLI_STATS << ": " << Err.message() << "\n";
+        return 1;
+      }
+      me3::typedb::write_timings(StatsOut, Timings);
+    }
+    if (!CLI_SIZE_REPORT.empty()) {
+      llvm::Expected<std::unique_ptr<llvm::raw_ostream>> ReportOut =
+          me3::typedb::open_output(CLI_SIZE_REPORT, {});
+      if (!ReportOut) {
+        llvm::errs() << llvm::toString(ReportOut.takeError()) << "\n";
+        return 1;
+      }
+      me3::typedb::write_size_report(
+          me3::typedb::build_size_report(Merged, Json), **ReportOut);
+    }
+    if (!CLI_EMIT_CPP.empty()) {
+      llvm::Expected<std::unique_ptr<llvm::raw_ostream>> CppOut =
+          me3::typedb::open_output(CLI_EMIT_CPP, {});
+      if (!CppOut) {
+        llvm::errs() << llvm::toString(CppOut.takeError()) << "\n";
+        return 1;
+      }
+      me3::typedb::CppHeaderOptions Cpp;
+      Cpp.namespace_name = CLI_CPP_NAMESPACE;
+      me3::typedb::typedb_to_cpp_header(Merged, **CppOut, Cpp);
+    }
+    if (!CLI_EMIT_BINARY.empty()) {
+      // Never compressed: readers map the file and use it in place.
+      if (llvm::Error Err = me3::typedb::write_typedb_binary_file(
+              Merged, CLI_EMIT_BINARY)) {
+        llvm::errs() << llvm::toString(std::move(Err)) << "\n";
+        return 1;
+      }
+    }
+    return Status;
   }
   return 1;
-}
\ No newline at end of file
+}
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -55,11 +60,85 @@ struct ObjectType {
   std::vector<ObjectField> fields;
 };
 
+struct Enumerator {
+  std::string name;
+  // Two's complement bits of the value; read as int64_t when the enum is
+  // signed.
+  uint64_t value = 0;
+};
+
 struct EnumType {
   uint64_t size_bytes = 0;
   uint64_t align_bytes = 0;
   std::string underlying_type;
-  std::vector<std::pair<std::string, std::string>> enumerators;
+  bool is_signed = false;
+  // Set by build_value_order() for enums that look like bit masks: every
+  // value is non-negative and made of single-bit enumerators, and the values
+  // are not one contiguous range.
+  bool is_flags = false;
+  std::vector<Enumerator> enumerators;
+  // Indices into `enumerators` ordered by value, ties in declaration order.
+  std::vector<uint32_t> value_order;
+
+  [[nodiscard]] auto value_less(uint64_t lhs, uint64_t rhs) const -> bool {
+    return is_signed ? static_cast<int64_t>(lhs) < static_cast<int64_t>(rhs)
+                     : lhs < rhs;
+  }
+
+  void build_value_order() {
+    value_order.resize(enumerators.size());
+    for (uint32_t i = 0; i < value_order.size(); ++i) {
+      value_order[i] = i;
+    }
+    std::stable_sort(value_order.begin(), value_order.end(),
+                     [&](uint32_t lhs, uint32_t rhs) {
+                       return value_less(enumerators[lhs].value,
+                                         enumerators[rhs].value);
+                     });
+
+    is_flags = false;
+    if (enumerators.empty()) {
+      return;
+    }
+    uint64_t single_bits = 0;
+    size_t distinct = 0;
+    for (size_t i = 0; i < value_order.size(); ++i) {
+      uint64_t value = enumerators[value_order[i]].value;
+      if (is_signed && static_cast<int64_t>(value) < 0) {
+        return;
+      }
+      if (std::has_single_bit(value)) {
+        single_bits |= value;
+      }
+      if (i == 0 || value != enumerators[value_order[i - 1]].value) {
+        ++distinct;
+      }
+    }
+    uint64_t lowest = enumerators[value_order.front()].value;
+    uint64_t highest = enumerators[value_order.back()].value;
+    bool contiguous = highest - lowest + 1 == distinct;
+    if (contiguous || std::popcount(single_bits) < 2) {
+      return;
+    }
+    is_flags = std::all_of(
+        enumerators.begin(), enumerators.end(), [&](const Enumerator &e) {
+          return (e.value & ~single_bits) == 0;
+        });
+  }
+
+  // First enumerator declared with `value`, by binary search over
+  // value_order; nullptr when there is none.
+  [[nodiscard]] auto find_value(uint64_t value) const -> const Enumerator * {
+    auto it = std::lower_bound(value_order.begin(), value_order.end(), value,
+                               [&](uint32_t index, uint64_t wanted) {
+                                 return value_less(enumerators[index].value,
+                                                   wanted);
+                               });
+    if (it == value_order.end() || enumerators[*it].value != value) {
+      return nullptr;
+    }
+    return &enumerators[*it];
+  }
 };
 
 struct VfTableType {
@@ -77,6 +156,8 @@ struct ObjectField {
   std::string name;
   uint64_t size_bytes = 0;
   std::optional<uint64_t> bit_width; // iff bitfield
+  // Offset from the start of the record, in bits; set iff the layout is known.
+  std::optional<uint64_t> offset_bits;
   bool is_base = false;
   bool is_virtual_base = false;
   bool is_vfptr = false;
@@ -94,23 +175,211 @@ using NodeVariant =
 struct Node {
   std::string name;
   NodeVariant data;
+  // C declaration spelling, only stored when it differs from `name`.
   std::string cdecl;
+
+  [[nodiscard]] auto cdecl_or_name() const -> const std::string & {
+    return cdecl.empty() ? name : cdecl;
+  }
+};
+
+// Position of Kind within NodeVariant, usable as a compact node tag.
+template <typename Kind, typename Variant = NodeVariant> struct NodeKindIndex;
+template <typename Kind, typename... Kinds>
+struct NodeKindIndex<Kind, std::variant<Kinds...>> {
+  static constexpr size_t value = [] {
+    constexpr bool matches[] = {std::is_same_v<Kind, Kinds>...};
+    for (size_t i = 0; i < sizeof...(Kinds); ++i) {
+      if (matches[i]) {
+        return i;
+      }
+    }
+    return sizeof...(Kinds);
+  }();
+  static_assert(value < sizeof...(Kinds), "not a NodeVariant alternative");
+};
+template <typename Kind>
+inline constexpr size_t node_kind_index_v = NodeKindIndex<Kind>::value;
+
+// Dense storage for every node of a single kind.
+template <typename Kind> struct NodeColumn {
+  std::vector<std::string> names;
+  std::vector<std::string> cdecls;
+  std::vector<Kind> data;
+};
+
+template <typename Variant> struct NodeColumnsFor;
+template <typename... Kinds> struct NodeColumnsFor<std::variant<Kinds...>> {
+  using type = std::tuple<NodeColumn<Kinds>...>;
+};
+using NodeColumns = NodeColumnsFor<NodeVariant>::type;
+
+// Tag/index table entry: which column a node lives in and at which row.
+struct NodeSlot {
+  uint8_t kind;
+  uint32_t row;
 };
 
 struct TypeDb {
+  // Nodes are held either interleaved in `nodes` (as produced by the
+  // builder) or, after columnize(), per kind in `columns` with `slots`
+  // preserving the original order. Use the for_each_node helpers to read
+  // them independently of layout.
   std::vector<Node> nodes;
+  NodeColumns columns;
+  std::vector<NodeSlot> slots;
   std::unordered_map<std::string, size_t> node_index;
   std::string triple;
   int pointer_width_bits = 0;
   int char_width_bits = 0;
   int long_width_bits = 0;
+
+  [[nodiscard]] auto is_columnar() const -> bool { return !slots.empty(); }
+
+  [[nodiscard]] auto node_count() const -> size_t {
+    return is_columnar() ? slots.size() : nodes.size();
+  }
+
   void build_indices() {
     node_index.clear();
+    node_index.reserve(node_count());
+    if (is_columnar()) {
+      for (size_t i = 0; i < slots.size(); ++i) {
+        node_index.emplace(slot_name(slots[i]), i);
+      }
+      return;
+    }
     for (size_t i = 0; i < nodes.size(); ++i) {
       node_index.emplace(nodes[i].name, i);
     }
   }
+
+  // Appends the nodes of `other` whose names are not present yet; the first
+  // definition of a name wins. Both dbs must still hold their nodes in
+  // `nodes` and this db must be indexed.
+  void merge_from(TypeDb &&other) {
+    if (triple.empty()) {
+      triple = std::move(other.triple);
+      pointer_width_bits = other.pointer_width_bits;
+      char_width_bits = other.char_width_bits;
+      long_width_bits = other.long_width_bits;
+    }
+    for (Node &node : other.nodes) {
+      if (node_index.emplace(node.name, nodes.size()).second) {
+        nodes.push_back(std::move(node));
+      }
+    }
+    other.nodes.clear();
+  }
+
+  // Moves `nodes` into per-kind columns. node_index keeps addressing nodes
+  // by their original position, which now indexes `slots`.
+  void columnize() {
+    if (nodes.empty()) {
+      return;
+    }
+    slots.reserve(slots.size() + nodes.size());
+    for (Node &node : nodes) {
+      std::visit(
+          [&](auto &&data) {
+            using Kind = std::decay_t<decltype(data)>;
+            auto &column = std::get<NodeColumn<Kind>>(columns);
+            slots.push_back(NodeSlot{
+                static_cast<uint8_t>(node_kind_index_v<Kind>),
+                static_cast<uint32_t>(column.data.size())});
+            column.names.push_back(std::move(node.name));
+            column.cdecls.push_back(std::move(node.cdecl));
+            column.data.push_back(std::move(data));
+          },
+          node.data);
+    }
+    nodes.clear();
+    nodes.shrink_to_fit();
+  }
+
+  template <typename Kind>
+  [[nodiscard]] auto column() const -> const NodeColumn<Kind> & {
+    return std::get<NodeColumn<Kind>>(columns);
+  }
+
+  // Calls fn(name, cdecl, data) for every node of the given kind. On a
+  // columnized db this walks one dense array without variant dispatch.
+  template <typename Kind, typename Fn> void for_each_node(Fn &&fn) const {
+    if (is_columnar()) {
+      const NodeColumn<Kind> &col = column<Kind>();
+      for (size_t row = 0; row < col.data.size(); ++row) {
+        fn(col.names[row], col.cdecls[row], col.data[row]);
+      }
+      return;
+    }
+    for (const Node &node : nodes) {
+      if (const auto *data = std::get_if<Kind>(&node.data)) {
+        fn(node.name, node.cdecl, *data);
+      }
+    }
+  }
+
+  // Calls fn(name, cdecl, data) for every node in insertion order, with data
+  // passed as its concrete kind.
+  template <typename Fn> void for_each_node(Fn &&fn) const {
+    if (!is_columnar()) {
+      for (const Node &node : nodes) {
+        std::visit([&](const auto &data) { fn(node.name, node.cdecl, data); },
+                   node.data);
+      }
+      return;
+    }
+    for (const NodeSlot &slot : slots) {
+      visit_slot(slot, fn,
+                 std::make_index_sequence<std::variant_size_v<NodeVariant>>{});
+    }
+  }
+
+private:
+  template <size_t Index, typename Fn>
+  void visit_row(uint32_t row, Fn &fn) const {
+    using Kind = std::variant_alternative_t<Index, NodeVariant>;
+    const NodeColumn<Kind> &col = column<Kind>();
+    fn(col.names[row], col.cdecls[row], col.data[row]);
+  }
+
+  template <typename Fn, size_t... Indices>
+  void visit_slot(NodeSlot slot, Fn &fn,
+                  std::index_sequence<Indices...> /*unused*/) const {
+    using RowVisitor = void (TypeDb::*)(uint32_t, Fn &) const;
+    static constexpr RowVisitor kVisitors[] = {
+        &TypeDb::visit_row<Indices, Fn>...};
+    (this->*kVisitors[slot.kind])(slot.row, fn);
+  }
+
+  [[nodiscard]] auto slot_name(NodeSlot slot) const -> const std::string & {
+    const std::string *name = nullptr;
+    auto capture = [&](const std::string &node_name,
+                       const std::string & /*cdecl*/,
+                       const auto & /*data*/) { name = &node_name; };
+    visit_slot(slot, capture,
+               std::make_index_sequence<std::variant_size_v<NodeVariant>>{});
+    return *name;
+  }
+};
+
+// Receives nodes as soon as the builder has finished them, instead of having
+// them accumulate in TypeDb::nodes.
+class NodeSink {
+public:
+  NodeSink() = default;
+  NodeSink(const NodeSink &) = delete;
+  auto operator=(const NodeSink &) -> NodeSink & = delete;
+  virtual ~NodeSink() = default;
+
+  // Called once per translation unit before its first node, with a db
+  // holding only target info, and once after its last node.
+  virtual void begin(const TypeDb &header) = 0;
+  virtual void node(Node &&node) = 0;
+  virtual void end() = 0;
 };
 
-inline constexpr const char *SCHEMA_VERSION = "5.0.0";
+inline constexpr const char *SCHEMA_VERSION = "7.0.0";
+// Last schema in which every non-record node carried an explicit cdecl.
+inline constexpr const char *LEGACY_SCHEMA_VERSION = "5.0.0";
 } // namespace me3::typedb
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "typedb_api.h"
+#include "typedb_pipeline.h"
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+
+namespace me3::typedb {
+
+auto default_compile_args(ParseMode mode) -> std::vector<std::string> {
+  std::vector<std::string> args = {"-std=c++17",
+                                   "--target=x86_64-pc-windows-msvc"};
+  if (mode == ParseMode::Full) {
+    args.insert(args.end(), {"-O0", "-g"});
+  }
+  return args;
+}
+
+auto build_from_source(const std::vector<std::string> &sources,
+                       const std::vector<std::string> &compile_args,
+                       const TypeDbCallback &callback,
+                       const BuildOptions &options, ParseMode mode) -> int {
+  clang::tooling::FixedCompilationDatabase const compilations(".",
+                                                              compile_args);
+  clang::tooling::ClangTool tool(compilations, sources);
+  TypeDbActionFactory factory(options, callback, mode);
+  return tool.run(&factory);
+}
+
+auto build_from_code(llvm::StringRef code, const std::string &file_name,
+                     const std::vector<std::string> &compile_args,
+                     const TypeDbCallback &callback,
+                     const BuildOptions &options, ParseMode mode) -> bool {
+  TypeDbActionFactory factory(options, callback, mode);
+  return clang::tooling::runToolOnCodeWithArgs(factory.create(), code,
+                                               compile_args, file_name);
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,33 @@
+#pragma once
+#include "typedb.h"
+#include "typedb_builder.h"
+#include "typedb_json.h"
+#include "typedb_pipeline.h"
+#include <llvm/ADT/StringRef.h>
+#include <string>
+#include <vector>
+
+namespace me3::typedb {
+
+// Compile arguments the command line tool uses by default: MSVC x64 target,
+// plus -O0 -g for full parses.
+auto default_compile_args(ParseMode mode = ParseMode::Full)
+    -> std::vector<std::string>;
+
+// Parses each source in-process with `compile_args` and calls `callback`
+// with its TypeDb on the calling thread. Returns ClangTool::run's status.
+auto build_from_source(const std::vector<std::string> &sources,
+                       const std::vector<std::string> &compile_args,
+                       const TypeDbCallback &callback,
+                       const BuildOptions &options = {},
+                       ParseMode mode = ParseMode::Full) -> int;
+
+// Like build_from_source, for an in-memory translation unit named
+// `file_name`. Returns false if the code failed to compile.
+auto build_from_code(llvm::StringRef code, const std::string &file_name,
+                     const std::vector<std::string> &compile_args,
+                     const TypeDbCallback &callback,
+                     const BuildOptions &options = {},
+                     ParseMode mode = ParseMode::Full) -> bool;
+
+} // namespace me3::typedb
@@ -0,0 +1,135 @@
+#include "typedb.h"
+#include "typedb_api.h"
+#include "typedb_metrics.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+constexpr const char *kPointCode = R"cpp(
+struct Point {
+  int x;
+  int y;
+};
+)cpp";
+
+auto has_arg(const std::vector<std::string> &args, llvm::StringRef arg)
+    -> bool {
+  return std::find(args.begin(), args.end(), arg) != args.end();
+}
+
+auto temp_source(llvm::StringRef code) -> std::string {
+  llvm::SmallString<256> path;
+  int fd = -1;
+  if (llvm::sys::fs::createTemporaryFile("typedb_api_test", "cpp", fd,
+                                         path)) {
+    return {};
+  }
+  llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+  out << code;
+  return std::string(path);
+}
+
+void check_point(const TypeDb &db) {
+  TYPEDB_CHECK_EQ(db.triple, std::string("x86_64-pc-windows-msvc"));
+  TYPEDB_CHECK_EQ(db.pointer_width_bits, 64);
+  auto point = db.node_index.find("Point");
+  TYPEDB_CHECK(point != db.node_index.end());
+  if (point == db.node_index.end()) {
+    return;
+  }
+  const auto *object = std::get_if<ObjectType>(&db.nodes[point->second].data);
+  TYPEDB_CHECK(object != nullptr);
+  if (object != nullptr) {
+    TYPEDB_CHECK_EQ(object->size_bytes, uint64_t{8});
+    TYPEDB_CHECK_EQ(object->fields.size(), size_t{2});
+  }
+}
+
+void test_default_compile_args() {
+  std::vector<std::string> full = default_compile_args();
+  TYPEDB_CHECK(has_arg(full, "--target=x86_64-pc-windows-msvc"));
+  TYPEDB_CHECK(has_arg(full, "-std=c++17"));
+  TYPEDB_CHECK(has_arg(full, "-O0"));
+  std::vector<std::string> fast = default_compile_args(ParseMode::Fast);
+  TYPEDB_CHECK(has_arg(fast, "--target=x86_64-pc-windows-msvc"));
+  TYPEDB_CHECK(!has_arg(fast, "-O0"));
+  TYPEDB_CHECK(!has_arg(fast, "-g"));
+}
+
+void test_build_from_code() {
+  std::vector<TypeDb> built;
+  bool compiled = build_from_code(
+      kPointCode, "point.cpp", default_compile_args(),
+      [&](TypeDb &&type_db) { built.push_back(std::move(type_db)); });
+  TYPEDB_CHECK(compiled);
+  TYPEDB_CHECK_EQ(built.size(), size_t{1});
+  if (!built.empty()) {
+    check_point(built.front());
+  }
+
+  // Options reach the builder.
+  BuildCounters counters;
+  BuildOptions options;
+  options.counters = &counters;
+  compiled = build_from_code(kPointCode, "point.cpp", default_compile_args(),
+                             [](TypeDb && /*type_db*/) {}, options);
+  TYPEDB_CHECK(compiled);
+  TYPEDB_CHECK_EQ(counters.records.load(), uint64_t{1});
+}
+
+void test_build_from_code_error() {
+  bool compiled =
+      build_from_code("struct Broken { int x }", "broken.cpp",
+                      default_compile_args(), [](TypeDb && /*type_db*/) {});
+  TYPEDB_CHECK(!compiled);
+}
+
+void test_build_from_source() {
+  std::string first = temp_source(kPointCode);
+  std::string second = temp_source("enum class Mode : short { A, B };\n");
+  std::vector<TypeDb> built;
+  int status = build_from_source(
+      {first, second}, default_compile_args(),
+      [&](TypeDb &&type_db) { built.push_back(std::move(type_db)); });
+  TYPEDB_CHECK_EQ(status, 0);
+  TYPEDB_CHECK_EQ(built.size(), size_t{2});
+  if (built.size() == 2) {
+    check_point(built[0]);
+    TYPEDB_CHECK(built[1].node_index.contains("Mode"));
+  }
+  llvm::sys::fs::remove(first);
+  llvm::sys::fs::remove(second);
+}
+
+void test_build_from_source_missing() {
+  llvm::SmallString<256> missing;
+  llvm::sys::fs::createUniquePath("typedb_api_missing-%%%%%%.cpp", missing,
+                                  /*MakeAbsolute=*/true);
+  int calls = 0;
+  int status = build_from_source({std::string(missing)},
+                                 default_compile_args(),
+                                 [&](TypeDb && /*type_db*/) { ++calls; });
+  TYPEDB_CHECK(status != 0);
+  TYPEDB_CHECK_EQ(calls, 0);
+}
+
+} // namespace
+
+auto main() -> int {
+  test_default_compile_args();
+  test_build_from_code();
+  test_build_from_code_error();
+  test_build_from_source();
+  test_build_from_source_missing();
+  return me3::typedb::test::test_result();
+}
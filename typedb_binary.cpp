@@ -0,0 +1,307 @@
+#include "typedb_binary.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Errc.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MathExtras.h>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace me3::typedb {
+namespace {
+
+namespace bin = binary;
+
+static_assert(static_cast<size_t>(bin::Kind::Unknown) + 1 ==
+                  std::variant_size_v<NodeVariant>,
+              "binary::Kind must list every NodeVariant alternative");
+
+constexpr uint64_t kTableAlign = 8;
+constexpr uint64_t kMaxIndex = std::numeric_limits<uint32_t>::max();
+
+// Flattens a TypeDb into the tables of the binary format.
+class BinaryBuilder {
+public:
+  void add(const std::string &name, const std::string &cdecl,
+           const BuiltinType &data) {
+    push_node(name, cdecl, bin::Kind::Builtin).text = intern(data.name);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const TemplateParameterType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::TemplateParam);
+    node.text = intern(data.name);
+    node.template_index = data.index;
+    node.template_depth = data.depth;
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const PointerType &data) {
+    push_node(name, cdecl, bin::Kind::Pointer).text = intern(data.pointee);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const FixedSizeArrayType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::ConstArray);
+    node.text = intern(data.elem);
+    node.size_bytes = data.size;
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const UnsizedArrayType &data) {
+    push_node(name, cdecl, bin::Kind::IncompleteArray).text =
+        intern(data.elem);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const FunctionType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::Function);
+    node.text = intern(data.return_type);
+    node.flags = data.variadic ? bin::kVariadic : 0;
+    std::tie(node.first_child, node.child_count) = push_strings(data.params);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const TemplateSpecializationType &data) {
+    bin::Node &node =
+        push_node(name, cdecl, bin::Kind::TemplateSpecialization);
+    node.text = intern(data.name);
+    std::tie(node.first_child, node.child_count) =
+        push_strings(data.type_args);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const ObjectType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::Object);
+    node.size_bytes = data.size_bytes;
+    node.align_bytes = data.align_bytes;
+    node.flags = (data.template_primary ? bin::kTemplatePrimary : 0) |
+                 (data.layout_dependent ? bin::kLayoutDependent : 0);
+    if (data.primary_template) {
+      node.flags |= bin::kHasPrimaryTemplate;
+      node.text = intern(*data.primary_template);
+    }
+    std::tie(node.first_child, node.child_count) = push_fields(data.fields);
+    std::tie(node.first_extra, node.extra_count) =
+        push_strings(data.template_type_args);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const EnumType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::Enum);
+    node.size_bytes = data.size_bytes;
+    node.align_bytes = data.align_bytes;
+    node.text = intern(data.underlying_type);
+    node.flags = (data.is_signed ? bin::kSigned : 0) |
+                 (data.is_flags ? bin::kFlagsEnum : 0);
+    node.first_child = checked_index(enumerators_.size());
+    node.child_count = checked_index(data.enumerators.size());
+    for (const Enumerator &enumerator : data.enumerators) {
+      enumerators_.push_back(
+          bin::Enumerator{intern(enumerator.name), enumerator.value});
+    }
+    node.first_extra = checked_index(indices_.size());
+    node.extra_count = checked_index(data.value_order.size());
+    indices_.insert(indices_.end(), data.value_order.begin(),
+                    data.value_order.end());
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const VfTableType &data) {
+    bin::Node &node = push_node(name, cdecl, bin::Kind::VfTable);
+    node.size_bytes = data.size_bytes;
+    node.align_bytes = data.align_bytes;
+    node.text = intern(data.original_record);
+    std::tie(node.first_child, node.child_count) = push_fields(data.fields);
+  }
+  void add(const std::string &name, const std::string &cdecl,
+           const UnknownType &data) {
+    push_node(name, cdecl, bin::Kind::Unknown).text = intern(data.spelling);
+  }
+
+  auto write(const TypeDb &type_db, llvm::raw_ostream &out) -> llvm::Error {
+    bin::Header header{};
+    std::memcpy(header.magic, bin::kMagic, sizeof(header.magic));
+    header.version = bin::kVersion;
+    header.pointer_width_bits = type_db.pointer_width_bits;
+    header.char_width_bits = type_db.char_width_bits;
+    header.long_width_bits = type_db.long_width_bits;
+    header.triple = intern(type_db.triple);
+
+    std::vector<uint32_t> name_index = sorted_name_index();
+    if (overflowed_ || strings_.size() > kMaxIndex) {
+      return llvm::createStringError(
+          llvm::errc::file_too_large,
+          "type db exceeds the 32-bit limits of the binary format");
+    }
+
+    // Tables follow the header in this order, each 8-byte aligned.
+    uint64_t offset = sizeof(bin::Header);
+    auto place = [&](bin::Section &section, uint64_t count, size_t width) {
+      offset = llvm::alignTo(offset, kTableAlign);
+      section = bin::Section{offset, count};
+      offset += count * width;
+    };
+    place(header.strings, strings_.size(), 1);
+    place(header.nodes, nodes_.size(), sizeof(bin::Node));
+    place(header.fields, fields_.size(), sizeof(bin::Field));
+    place(header.enumerators, enumerators_.size(), sizeof(bin::Enumerator));
+    place(header.string_lists, string_lists_.size(), sizeof(bin::StringRef));
+    place(header.indices, indices_.size(), sizeof(uint32_t));
+    place(header.name_index, name_index.size(), sizeof(uint32_t));
+
+    uint64_t written = 0;
+    auto emit = [&](const bin::Section &section, const void *data,
+                    size_t bytes) {
+      out.write_zeros(section.offset - written);
+      out.write(static_cast<const char *>(data), bytes);
+      written = section.offset + bytes;
+    };
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    written = sizeof(header);
+    emit(header.strings, strings_.data(), strings_.size());
+    emit(header.nodes, nodes_.data(), nodes_.size() * sizeof(bin::Node));
+    emit(header.fields, fields_.data(), fields_.size() * sizeof(bin::Field));
+    emit(header.enumerators, enumerators_.data(),
+         enumerators_.size() * sizeof(bin::Enumerator));
+    emit(header.string_lists, string_lists_.data(),
+         string_lists_.size() * sizeof(bin::StringRef));
+    emit(header.indices, indices_.data(), indices_.size() * sizeof(uint32_t));
+    emit(header.name_index, name_index.data(),
+         name_index.size() * sizeof(uint32_t));
+    out.write_zeros(llvm::alignTo(written, kTableAlign) - written);
+    return llvm::Error::success();
+  }
+
+private:
+  auto checked_index(size_t value) -> uint32_t {
+    if (value > kMaxIndex) {
+      overflowed_ = true;
+    }
+    return static_cast<uint32_t>(value);
+  }
+
+  // Each distinct string is stored once.
+  auto intern(llvm::StringRef value) -> bin::StringRef {
+    if (value.empty()) {
+      return {};
+    }
+    auto [it, inserted] =
+        string_offsets_.try_emplace(value, checked_index(strings_.size()));
+    if (inserted) {
+      strings_.append(value.begin(), value.end());
+    }
+    return bin::StringRef{it->second, checked_index(value.size())};
+  }
+
+  auto push_node(const std::string &name, const std::string &cdecl,
+                 bin::Kind kind) -> bin::Node & {
+    bin::Node &node = nodes_.emplace_back();
+    node.name = intern(name);
+    node.cdecl = cdecl.empty() || cdecl == name ? bin::StringRef{}
+                                                : intern(cdecl);
+    node.kind = kind;
+    return node;
+  }
+
+  auto push_strings(const std::vector<std::string> &values)
+      -> std::pair<uint32_t, uint32_t> {
+    uint32_t first = checked_index(string_lists_.size());
+    for (const std::string &value : values) {
+      string_lists_.push_back(intern(value));
+    }
+    return {first, checked_index(values.size())};
+  }
+
+  auto push_fields(const std::vector<ObjectField> &values)
+      -> std::pair<uint32_t, uint32_t> {
+    uint32_t first = checked_index(fields_.size());
+    for (const ObjectField &value : values) {
+      bin::Field &field = fields_.emplace_back();
+      field.name = intern(value.name);
+      field.type = intern(value.type_id);
+      field.size_bytes = value.size_bytes;
+      field.offset_bits = value.offset_bits.value_or(0);
+      field.bit_width = static_cast<uint32_t>(value.bit_width.value_or(0));
+      field.flags = (value.is_base ? bin::kBase : 0) |
+                    (value.is_virtual_base ? bin::kVirtualBase : 0) |
+                    (value.is_vfptr ? bin::kVfPtr : 0) |
+                    (value.is_bitfield ? bin::kBitfield : 0) |
+                    (value.layout_known ? bin::kLayoutKnown : 0) |
+                    (value.offset_bits ? bin::kHasOffset : 0) |
+                    (value.bit_width ? bin::kHasBitWidth : 0);
+    }
+    return {first, checked_index(values.size())};
+  }
+
+  auto node_name(uint32_t node) const -> llvm::StringRef {
+    const bin::StringRef &name = nodes_[node].name;
+    return llvm::StringRef(strings_).substr(name.offset, name.size);
+  }
+
+  auto sorted_name_index() -> std::vector<uint32_t> {
+    std::vector<uint32_t> order(nodes_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = checked_index(i);
+    }
+    // StringRef::compare orders bytes as unsigned, like memcmp in readers.
+    std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+      return node_name(lhs).compare(node_name(rhs)) < 0;
+    });
+    return order;
+  }
+
+  std::string strings_;
+  llvm::StringMap<uint32_t> string_offsets_;
+  std::vector<bin::Node> nodes_;
+  std::vector<bin::Field> fields_;
+  std::vector<bin::Enumerator> enumerators_;
+  std::vector<bin::StringRef> string_lists_;
+  std::vector<uint32_t> indices_;
+  bool overflowed_ = false;
+};
+
+} // namespace
+
+auto write_typedb_binary(const TypeDb &type_db, llvm::raw_ostream &out)
+    -> llvm::Error {
+  if constexpr (!llvm::sys::IsLittleEndianHost) {
+    return llvm::createStringError(
+        llvm::errc::not_supported,
+        "the binary type db can only be written on little-endian hosts");
+  }
+  BinaryBuilder builder;
+  type_db.for_each_node(
+      [&](const std::string &name, const std::string &cdecl,
+          const auto &data) { builder.add(name, cdecl, data); });
+  return builder.write(type_db, out);
+}
+
+auto write_typedb_binary_file(const TypeDb &type_db, llvm::StringRef path)
+    -> llvm::Error {
+  // 0666 less the umask, as for any other output file; the file keeps this
+  // mode when it is renamed into place.
+  llvm::Expected<llvm::sys::fs::TempFile> temp =
+      llvm::sys::fs::TempFile::create(
+          path + "-%%%%%%.tmp",
+          llvm::sys::fs::all_read | llvm::sys::fs::all_write);
+  if (!temp) {
+    return llvm::createFileError(path, temp.takeError());
+  }
+  llvm::Error error = llvm::Error::success();
+  {
+    llvm::raw_fd_ostream out(temp->FD, /*shouldClose=*/false);
+    error = write_typedb_binary(type_db, out);
+    out.flush();
+    if (!error && out.has_error()) {
+      error = llvm::createFileError(temp->TmpName, out.error());
+    }
+    out.clear_error();
+  }
+  if (error) {
+    return llvm::joinErrors(std::move(error), temp->discard());
+  }
+  if (llvm::Error kept = temp->keep(path)) {
+    return llvm::createFileError(path, std::move(kept));
+  }
+  return llvm::Error::success();
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,22 @@
+#pragma once
+#include "typedb.h"
+#include "typedb_binary_format.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace me3::typedb {
+
+// Writes `type_db` in the memory-mappable layout described in
+// typedb_binary_format.h. `out` must not compress, or the result can no
+// longer be mapped. Fails when the string blob or a table outgrows its
+// 32-bit indices.
+auto write_typedb_binary(const TypeDb &type_db, llvm::raw_ostream &out)
+    -> llvm::Error;
+
+// Writes `type_db` to a temporary file beside `path` and renames it over
+// `path`, so a reader that still maps the old file keeps seeing it intact.
+auto write_typedb_binary_file(const TypeDb &type_db, llvm::StringRef path)
+    -> llvm::Error;
+
+} // namespace me3::typedb
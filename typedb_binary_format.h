@@ -0,0 +1,132 @@
+#pragma once
+// On-disk layout of the binary TypeDb written by write_typedb_binary. Kept
+// free of LLVM and of the rest of the library so that readers such as the
+// Python extension can include it on its own.
+//
+// All integers are little-endian and every table is 8-byte aligned, so a
+// reader can memory-map the file and use the tables in place. Strings are
+// stored once in a blob and referenced by StringRef; they are not
+// NUL-terminated.
+#include <cstddef>
+#include <cstdint>
+
+namespace me3::typedb::binary {
+
+inline constexpr char kMagic[8] = {'M', 'E', '3', 'T', 'Y', 'D', 'B', '\0'};
+inline constexpr uint32_t kVersion = 1;
+
+struct StringRef {
+  uint32_t offset;
+  uint32_t size;
+};
+
+// Byte range of one table within the file.
+struct Section {
+  uint64_t offset;
+  uint64_t count;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  int32_t pointer_width_bits;
+  int32_t char_width_bits;
+  int32_t long_width_bits;
+  StringRef triple;
+  // Raw bytes; count is the blob size.
+  Section strings;
+  // Node records in TypeDb order.
+  Section nodes;
+  Section fields;
+  Section enumerators;
+  // StringRef lists: function params and template arguments.
+  Section string_lists;
+  // uint32_t lists: enum value orders.
+  Section indices;
+  // uint32_t node numbers sorted by name bytes, for binary search.
+  Section name_index;
+};
+
+// NodeVariant alternative of a node.
+enum class Kind : uint8_t {
+  Builtin,
+  TemplateParam,
+  Pointer,
+  ConstArray,
+  IncompleteArray,
+  Function,
+  TemplateSpecialization,
+  Object,
+  Enum,
+  VfTable,
+  Unknown,
+};
+
+// Bits of Node::flags.
+inline constexpr uint8_t kVariadic = 1U << 0;
+inline constexpr uint8_t kTemplatePrimary = 1U << 1;
+inline constexpr uint8_t kLayoutDependent = 1U << 2;
+inline constexpr uint8_t kHasPrimaryTemplate = 1U << 3;
+inline constexpr uint8_t kSigned = 1U << 4;
+inline constexpr uint8_t kFlagsEnum = 1U << 5;
+
+// One node. Which members are used depends on `kind`:
+//   text: builtin and template_param name, pointee, array elem, function
+//         return type, template_specialization name, enum underlying type,
+//         vftable original record, unknown spelling, object primary template
+//   size_bytes: object, enum and vftable size; const_array element count
+//   children: fields of objects and vftables, enumerators of enums, params
+//             of functions, type args of template specializations
+//   extras: template_type_args of objects (string_lists), value order of
+//           enums (indices)
+struct Node {
+  StringRef name;
+  // Empty unless it differs from name.
+  StringRef cdecl;
+  Kind kind;
+  uint8_t flags;
+  uint16_t reserved;
+  int32_t template_index;
+  uint64_t size_bytes;
+  uint64_t align_bytes;
+  StringRef text;
+  uint32_t first_child;
+  uint32_t child_count;
+  uint32_t first_extra;
+  uint32_t extra_count;
+  int32_t template_depth;
+  uint32_t reserved2;
+};
+
+// Bits of Field::flags.
+inline constexpr uint32_t kBase = 1U << 0;
+inline constexpr uint32_t kVirtualBase = 1U << 1;
+inline constexpr uint32_t kVfPtr = 1U << 2;
+inline constexpr uint32_t kBitfield = 1U << 3;
+inline constexpr uint32_t kLayoutKnown = 1U << 4;
+inline constexpr uint32_t kHasOffset = 1U << 5;
+inline constexpr uint32_t kHasBitWidth = 1U << 6;
+
+struct Field {
+  StringRef name;
+  StringRef type;
+  uint64_t size_bytes;
+  uint64_t offset_bits;
+  uint32_t bit_width;
+  uint32_t flags;
+};
+
+struct Enumerator {
+  StringRef name;
+  // Two's complement; signed when the owning node has kSigned.
+  uint64_t value;
+};
+
+static_assert(sizeof(StringRef) == 8);
+static_assert(sizeof(Section) == 16);
+static_assert(sizeof(Header) == 144);
+static_assert(sizeof(Node) == 72);
+static_assert(sizeof(Field) == 40);
+static_assert(sizeof(Enumerator) == 16);
+
+} // namespace me3::typedb::binary
@@ -0,0 +1,411 @@
+#include "typedb.h"
+#include "typedb_binary.h"
+#include "typedb_binary_format.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace me3::typedb;
+namespace bin = me3::typedb::binary;
+
+namespace {
+
+void add_node(TypeDb &db, std::string name, NodeVariant data) {
+  Node node;
+  node.name = std::move(name);
+  node.data = std::move(data);
+  db.nodes.push_back(std::move(node));
+}
+
+auto make_field(std::string name, std::string type_id, uint64_t size_bytes,
+                uint64_t offset_bits) -> ObjectField {
+  ObjectField field;
+  field.name = std::move(name);
+  field.type_id = std::move(type_id);
+  field.size_bytes = size_bytes;
+  field.offset_bits = offset_bits;
+  return field;
+}
+
+auto make_enum(std::vector<Enumerator> enumerators, bool is_signed)
+    -> EnumType {
+  EnumType type;
+  type.size_bytes = 8;
+  type.align_bytes = 8;
+  type.underlying_type = is_signed ? "long long" : "unsigned long long";
+  type.is_signed = is_signed;
+  type.enumerators = std::move(enumerators);
+  type.build_value_order();
+  return type;
+}
+
+// One node of every kind, in bin::Kind order with a signed and an unsigned
+// enum. typedb_python_test.py reads the fixture main() writes from it.
+auto sample_db() -> TypeDb {
+  TypeDb db;
+  db.triple = "x86_64-pc-windows-msvc";
+  db.pointer_width_bits = 64;
+  db.char_width_bits = 8;
+  db.long_width_bits = 32;
+  add_node(db, "int", BuiltinType{"int"});
+  add_node(db, "T", TemplateParameterType{.index = 1, .depth = 2, .name = "T"});
+  add_node(db, "int *", PointerType{"int"});
+  add_node(db, "int[4]", FixedSizeArrayType{.size = 4, .elem = "int"});
+  add_node(db, "int[]", UnsizedArrayType{"int"});
+  add_node(db, "void (int, ...)",
+           FunctionType{.return_type = "void",
+                        .params = {"int"},
+                        .variadic = true});
+  add_node(db, "Box<T>",
+           TemplateSpecializationType{.name = "Box", .type_args = {"T"}});
+
+  ObjectType packed;
+  packed.size_bytes = 16;
+  packed.align_bytes = 8;
+  packed.primary_template = "Box";
+  packed.template_type_args = {"int"};
+  ObjectField vfptr = make_field("__vfptr", "void *", 8, 0);
+  vfptr.is_vfptr = true;
+  packed.fields.push_back(std::move(vfptr));
+  packed.fields.push_back(make_field("count", "int", 4, 64));
+  ObjectField bits = make_field("bits", "unsigned int", 4, 96 + 3);
+  bits.is_bitfield = true;
+  bits.bit_width = 5;
+  packed.fields.push_back(std::move(bits));
+  ObjectField dependent = make_field("value", "T", 0, 0);
+  dependent.offset_bits.reset();
+  dependent.layout_known = false;
+  packed.fields.push_back(std::move(dependent));
+  add_node(db, "Box<int>", std::move(packed));
+
+  add_node(db, "Signed",
+           make_enum({{"Zero", 0},
+                      {"Min", static_cast<uint64_t>(INT64_MIN)},
+                      {"Neg", static_cast<uint64_t>(-1)}},
+                     true));
+  add_node(db, "Unsigned",
+           make_enum({{"Max", UINT64_MAX}, {"One", 1}, {"High", 1ULL << 63}},
+                     false));
+
+  VfTableType table;
+  table.original_record = "Box<int>";
+  table.size_bytes = 16;
+  table.align_bytes = 8;
+  table.fields = {make_field("~Box", "void *", 8, 0),
+                  make_field("get", "void *", 8, 64)};
+  add_node(db, "Box<int>::vftable", std::move(table));
+  add_node(db, "decltype(auto)", UnknownType{"decltype(auto)"});
+  db.build_indices();
+  return db;
+}
+
+auto to_binary(const TypeDb &db) -> std::string {
+  std::string bytes;
+  llvm::raw_string_ostream out(bytes);
+  if (llvm::Error error = write_typedb_binary(db, out)) {
+    TYPEDB_CHECK_EQ(llvm::toString(std::move(error)), std::string());
+  }
+  return out.str();
+}
+
+// Typed access to the tables of a written file.
+class Reader {
+public:
+  explicit Reader(std::string bytes) : bytes_(std::move(bytes)) {
+    std::memcpy(&header_, bytes_.data(), sizeof(header_));
+  }
+
+  auto header() const -> const bin::Header & { return header_; }
+
+  template <typename T>
+  auto at(const bin::Section &section, uint64_t index) const -> T {
+    T value;
+    std::memcpy(&value, bytes_.data() + section.offset + index * sizeof(T),
+                sizeof(T));
+    return value;
+  }
+  auto node(uint64_t index) const -> bin::Node {
+    return at<bin::Node>(header_.nodes, index);
+  }
+  auto field(uint64_t index) const -> bin::Field {
+    return at<bin::Field>(header_.fields, index);
+  }
+  auto text(bin::StringRef ref) const -> std::string {
+    return bytes_.substr(header_.strings.offset + ref.offset, ref.size);
+  }
+  auto string_list(uint32_t first, uint32_t count) const -> std::string {
+    std::string joined;
+    for (uint32_t i = 0; i < count; ++i) {
+      joined += text(at<bin::StringRef>(header_.string_lists, first + i));
+      joined += " ";
+    }
+    return joined;
+  }
+  // Enumerator names in value order.
+  auto value_order(const bin::Node &node) const -> std::string {
+    std::string names;
+    for (uint32_t i = 0; i < node.extra_count; ++i) {
+      uint32_t index = at<uint32_t>(header_.indices, node.first_extra + i);
+      names += text(at<bin::Enumerator>(header_.enumerators,
+                                        node.first_child + index)
+                        .name);
+      names += " ";
+    }
+    return names;
+  }
+
+private:
+  std::string bytes_;
+  bin::Header header_{};
+};
+
+void test_header() {
+  std::string bytes = to_binary(sample_db());
+  Reader reader(bytes);
+  const bin::Header &head = reader.header();
+  TYPEDB_CHECK(std::memcmp(head.magic, bin::kMagic, sizeof(bin::kMagic)) == 0);
+  TYPEDB_CHECK_EQ(head.version, bin::kVersion);
+  TYPEDB_CHECK_EQ(head.pointer_width_bits, 64);
+  TYPEDB_CHECK_EQ(head.char_width_bits, 8);
+  TYPEDB_CHECK_EQ(head.long_width_bits, 32);
+  TYPEDB_CHECK_EQ(reader.text(head.triple),
+                  std::string("x86_64-pc-windows-msvc"));
+  TYPEDB_CHECK_EQ(bytes.size() % 8, size_t{0});
+  for (const bin::Section *section :
+       {&head.strings, &head.nodes, &head.fields, &head.enumerators,
+        &head.string_lists, &head.indices, &head.name_index}) {
+    TYPEDB_CHECK_EQ(section->offset % 8, uint64_t{0});
+    TYPEDB_CHECK(section->offset <= bytes.size());
+  }
+  TYPEDB_CHECK_EQ(head.nodes.count, uint64_t{12});
+  TYPEDB_CHECK_EQ(head.fields.count, uint64_t{6});
+  TYPEDB_CHECK_EQ(head.enumerators.count, uint64_t{6});
+  TYPEDB_CHECK_EQ(head.indices.count, uint64_t{6});
+  TYPEDB_CHECK_EQ(head.name_index.count, head.nodes.count);
+}
+
+void test_every_kind() {
+  Reader reader(to_binary(sample_db()));
+  const bin::Kind kinds[] = {bin::Kind::Builtin,
+                             bin::Kind::TemplateParam,
+                             bin::Kind::Pointer,
+                             bin::Kind::ConstArray,
+                             bin::Kind::IncompleteArray,
+                             bin::Kind::Function,
+                             bin::Kind::TemplateSpecialization,
+                             bin::Kind::Object,
+                             bin::Kind::Enum,
+                             bin::Kind::Enum,
+                             bin::Kind::VfTable,
+                             bin::Kind::Unknown};
+  for (uint32_t i = 0; i < std::size(kinds); ++i) {
+    TYPEDB_CHECK_EQ(static_cast<unsigned>(reader.node(i).kind),
+                    static_cast<unsigned>(kinds[i]));
+  }
+
+  bin::Node builtin = reader.node(0);
+  TYPEDB_CHECK_EQ(reader.text(builtin.name), std::string("int"));
+  TYPEDB_CHECK_EQ(builtin.cdecl.size, 0U);
+  TYPEDB_CHECK_EQ(reader.text(builtin.text), std::string("int"));
+
+  bin::Node param = reader.node(1);
+  TYPEDB_CHECK_EQ(param.template_index, 1);
+  TYPEDB_CHECK_EQ(param.template_depth, 2);
+
+  TYPEDB_CHECK_EQ(reader.text(reader.node(2).text), std::string("int"));
+  TYPEDB_CHECK_EQ(reader.node(3).size_bytes, uint64_t{4});
+  TYPEDB_CHECK_EQ(reader.text(reader.node(4).text), std::string("int"));
+
+  bin::Node function = reader.node(5);
+  TYPEDB_CHECK_EQ(reader.text(function.text), std::string("void"));
+  TYPEDB_CHECK(function.flags & bin::kVariadic);
+  TYPEDB_CHECK_EQ(reader.string_list(function.first_child,
+                                     function.child_count),
+                  std::string("int "));
+
+  bin::Node specialization = reader.node(6);
+  TYPEDB_CHECK_EQ(reader.text(specialization.text), std::string("Box"));
+  TYPEDB_CHECK_EQ(reader.string_list(specialization.first_child,
+                                     specialization.child_count),
+                  std::string("T "));
+
+  bin::Node object = reader.node(7);
+  TYPEDB_CHECK_EQ(object.size_bytes, uint64_t{16});
+  TYPEDB_CHECK_EQ(object.align_bytes, uint64_t{8});
+  TYPEDB_CHECK(object.flags & bin::kHasPrimaryTemplate);
+  TYPEDB_CHECK_EQ(reader.text(object.text), std::string("Box"));
+  TYPEDB_CHECK_EQ(object.child_count, 4U);
+  TYPEDB_CHECK_EQ(reader.string_list(object.first_extra, object.extra_count),
+                  std::string("int "));
+
+  bin::Node table = reader.node(10);
+  TYPEDB_CHECK_EQ(reader.text(table.text), std::string("Box<int>"));
+  TYPEDB_CHECK_EQ(table.child_count, 2U);
+  TYPEDB_CHECK_EQ(reader.text(reader.field(table.first_child + 1).name),
+                  std::string("get"));
+  TYPEDB_CHECK_EQ(reader.text(reader.node(11).text),
+                  std::string("decltype(auto)"));
+}
+
+void test_fields() {
+  Reader reader(to_binary(sample_db()));
+  bin::Node object = reader.node(7);
+  bin::Field vfptr = reader.field(object.first_child);
+  TYPEDB_CHECK(vfptr.flags & bin::kVfPtr);
+  TYPEDB_CHECK(vfptr.flags & bin::kLayoutKnown);
+
+  bin::Field count = reader.field(object.first_child + 1);
+  TYPEDB_CHECK_EQ(reader.text(count.type), std::string("int"));
+  TYPEDB_CHECK_EQ(count.offset_bits, uint64_t{64});
+  TYPEDB_CHECK(!(count.flags & bin::kBitfield));
+
+  bin::Field bits = reader.field(object.first_child + 2);
+  TYPEDB_CHECK_EQ(bits.offset_bits, uint64_t{99});
+  TYPEDB_CHECK_EQ(bits.bit_width, 5U);
+  TYPEDB_CHECK_EQ(bits.flags & (bin::kBitfield | bin::kHasOffset |
+                                bin::kHasBitWidth),
+                  bin::kBitfield | bin::kHasOffset | bin::kHasBitWidth);
+
+  bin::Field dependent = reader.field(object.first_child + 3);
+  TYPEDB_CHECK_EQ(dependent.flags & (bin::kHasOffset | bin::kLayoutKnown),
+                  0U);
+}
+
+void test_enums() {
+  Reader reader(to_binary(sample_db()));
+  bin::Node is_signed = reader.node(8);
+  TYPEDB_CHECK(is_signed.flags & bin::kSigned);
+  TYPEDB_CHECK_EQ(reader.value_order(is_signed), std::string("Min Neg Zero "));
+  TYPEDB_CHECK_EQ(reader
+                      .at<bin::Enumerator>(reader.header().enumerators,
+                                           is_signed.first_child + 1)
+                      .value,
+                  static_cast<uint64_t>(INT64_MIN));
+
+  bin::Node is_unsigned = reader.node(9);
+  TYPEDB_CHECK(!(is_unsigned.flags & bin::kSigned));
+  TYPEDB_CHECK_EQ(reader.value_order(is_unsigned),
+                  std::string("One High Max "));
+  TYPEDB_CHECK_EQ(reader
+                      .at<bin::Enumerator>(reader.header().enumerators,
+                                           is_unsigned.first_child)
+                      .value,
+                  UINT64_MAX);
+}
+
+void test_name_index() {
+  Reader reader(to_binary(sample_db()));
+  const bin::Header &head = reader.header();
+  std::vector<bool> seen(head.nodes.count);
+  std::string previous;
+  for (uint64_t i = 0; i < head.name_index.count; ++i) {
+    uint32_t index = reader.at<uint32_t>(head.name_index, i);
+    TYPEDB_CHECK(index < head.nodes.count);
+    if (index >= head.nodes.count) {
+      return;
+    }
+    seen[index] = true;
+    std::string name = reader.text(reader.node(index).name);
+    TYPEDB_CHECK(i == 0 || llvm::StringRef(previous).compare(name) < 0);
+    previous = std::move(name);
+  }
+  TYPEDB_CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+}
+
+// Rewriting the file leaves a reader's mapping of the old one intact.
+void test_replace_file() {
+  llvm::SmallString<256> dir;
+  if (llvm::sys::fs::createUniqueDirectory("typedb_binary_test", dir)) {
+    TYPEDB_CHECK(false);
+    return;
+  }
+  llvm::SmallString<256> path(dir);
+  llvm::sys::path::append(path, "types.bin");
+
+  TypeDb db = sample_db();
+  std::string old_bytes = to_binary(db);
+  TYPEDB_CHECK(!llvm::errorToBool(write_typedb_binary_file(db, path)));
+
+  int fd = -1;
+  TYPEDB_CHECK(!llvm::sys::fs::openFileForRead(path, fd));
+  std::error_code error;
+  llvm::sys::fs::mapped_file_region mapped(
+      llvm::sys::fs::convertFDToNativeFile(fd),
+      llvm::sys::fs::mapped_file_region::readonly, old_bytes.size(), 0,
+      error);
+  llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+  TYPEDB_CHECK(!error);
+
+  db.triple = "aarch64-unknown-linux-gnu";
+  std::string new_bytes = to_binary(db);
+  TYPEDB_CHECK(!llvm::errorToBool(write_typedb_binary_file(db, path)));
+  if (!error) {
+    TYPEDB_CHECK(llvm::StringRef(mapped.const_data(), mapped.size()) ==
+                 old_bytes);
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> written =
+      llvm::MemoryBuffer::getFile(path);
+  TYPEDB_CHECK(static_cast<bool>(written));
+  if (written) {
+    TYPEDB_CHECK((*written)->getBuffer() == new_bytes);
+  }
+
+  // Only the target remains; the temporary file was renamed over it.
+  std::error_code walk_error;
+  unsigned entries = 0;
+  for (llvm::sys::fs::directory_iterator it(dir, walk_error), end;
+       it != end && !walk_error; it.increment(walk_error)) {
+    ++entries;
+  }
+  TYPEDB_CHECK_EQ(entries, 1U);
+#ifndef _WIN32
+  // Created like any other output file, not private to the writer.
+  llvm::ErrorOr<llvm::sys::fs::perms> mode =
+      llvm::sys::fs::getPermissions(path);
+  TYPEDB_CHECK(static_cast<bool>(mode));
+  if (mode) {
+    unsigned expected = (llvm::sys::fs::all_read | llvm::sys::fs::all_write) &
+                        ~llvm::sys::fs::getUmask();
+    TYPEDB_CHECK_EQ(static_cast<unsigned>(*mode), expected);
+  }
+#endif
+  mapped.unmap();
+  llvm::sys::fs::remove(path);
+  llvm::sys::fs::remove(dir);
+}
+
+} // namespace
+
+// With a path argument, only writes sample_db() there as the fixture for
+// typedb_python_test.py.
+auto main(int argc, char **argv) -> int {
+  if (argc == 2) {
+    if (llvm::Error error = write_typedb_binary_file(sample_db(), argv[1])) {
+      llvm::errs() << llvm::toString(std::move(error)) << "\n";
+      return 1;
+    }
+    return 0;
+  }
+  test_header();
+  test_every_kind();
+  test_fields();
+  test_enums();
+  test_name_index();
+  test_replace_file();
+  return me3::typedb::test::test_result();
+}
@@ -1,5 +1,7 @@
 #include "typedb_builder.h"
 #include "typedb.h"
+#include "typedb_interner.h"
+#include "typedb_paths.h"
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/Decl.h>
 #include <clang/AST/DeclCXX.h>
@@ -9,14 +11,24 @@
 #include <clang/AST/Type.h>
 #include <clang/AST/VTableBuilder.h>
 #include <clang/Basic/AddressSpaces.h>
+#include <clang/Basic/FileManager.h>
 #include <clang/Basic/LangOptions.h>
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
 #include <clang/Basic/TargetInfo.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallString.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -25,16 +37,27 @@ namespace {
 
 constexpr uint64_t kBitsPerByte = 8;
 constexpr unsigned kWorklistInitialCapacity = 64;
-constexpr unsigned kSmallStringBuffer = 32;
-constexpr unsigned kDecimalBase = 10;
+constexpr unsigned kEnumValueBits = 64;
 
 struct TypeInterner {
   clang::ASTContext *context;
   std::vector<Node> *nodes;
-  std::unordered_map<std::string, size_t> index; // id -> node index
+  // Canonical id strings live in the build's interner; each TU keeps views
+  // of the ones it has interned so far, so repeats never take its locks.
+  TypeIdInterner *type_ids = nullptr;
+  llvm::DenseSet<llvm::StringRef> index;
   llvm::DenseSet<const clang::CXXRecordDecl *> *seen_records;
   llvm::SmallVector<const clang::CXXRecordDecl *, kWorklistInitialCapacity>
       *worklist;
+  // Complete enums referenced by emitted types, drained by the visitor so
+  // enums declared in filtered-out files are still emitted on demand.
+  llvm::DenseSet<const clang::EnumDecl *> seen_enums;
+  llvm::SmallVector<const clang::EnumDecl *, kWorklistInitialCapacity>
+      pending_enums;
+  // Set when several interners share one ASTContext. Clang's lazily filled
+  // caches and type printers are not thread safe, so every ASTContext query
+  // on the record-building path goes through locked() while it is set.
+  std::mutex *type_mutex = nullptr;
   clang::PrintingPolicy c_policy;
   TypeInterner(clang::ASTContext &context, std::vector<Node> &all_nodes,
                llvm::DenseSet<const clang::CXXRecordDecl *> &seen,
@@ -49,33 +72,69 @@ struct TypeInterner {
     c_policy.AnonymousTagLocations = false;
   }
 
+  auto type_lock() const -> std::unique_lock<std::mutex> {
+    return type_mutex != nullptr ? std::unique_lock(*type_mutex)
+                                 : std::unique_lock<std::mutex>();
+  }
+
+  // Runs one ASTContext query under type_mutex. The mutex is not recursive,
+  // so `query` must not call back into the interner.
+  template <typename Fn> auto locked(Fn &&query) const -> decltype(query()) {
+    auto lock = type_lock();
+    return query();
+  }
+
   auto as_c_decl(clang::QualType qual_type) const -> std::string {
     clang::QualType canon = qual_type.getCanonicalType();
-    return canon.getAsString(c_policy);
+    return locked([&] { return canon.getAsString(c_policy); });
   }
 
-  auto intern(Node &&node, const std::string &id_str) -> std::string {
+  auto qualified_name(const clang::NamedDecl *decl) const -> std::string {
+    return locked([&] { return decl->getQualifiedNameAsString(); });
+  }
+
+  auto as_constant_array(clang::QualType canon) const
+      -> const clang::ConstantArrayType * {
+    auto lock = type_lock();
+    return context->getAsConstantArrayType(canon);
+  }
+
+  auto as_incomplete_array(clang::QualType canon) const
+      -> const clang::IncompleteArrayType * {
+    auto lock = type_lock();
+    return context->getAsIncompleteArrayType(canon);
+  }
+
+  // Records `id_str` as interned; false if it already was.
+  auto mark_interned(const std::string &id_str) -> bool {
     if (index.contains(id_str)) {
+      return false;
+    }
+    index.insert(type_ids->canonical(id_str));
+    return true;
+  }
+
+  auto intern(Node &&node, const std::string &id_str) -> std::string {
+    if (!mark_interned(id_str)) {
       return id_str;
     }
     Node local = std::move(node);
     local.name = id_str;
-    if (local.cdecl.empty()) {
-      local.cdecl = id_str;
+    if (local.cdecl == id_str) {
+      local.cdecl.clear();
     }
     nodes->push_back(std::move(local));
-    index.emplace(id_str, nodes->size() - 1);
     return id_str;
   }
   auto make_pointer_to(const std::string &pointee) -> std::string {
     std::string id_str = pointee + " *";
-    if (index.contains(id_str)) {
-      return id_str;
+    if (mark_interned(id_str)) {
+      Node node;
+      node.name = id_str;
+      node.data = PointerType{pointee};
+      nodes->push_back(std::move(node));
     }
-    Node node;
-    node.data = PointerType{pointee};
-    node.cdecl = id_str;
-    return intern(std::move(node), id_str);
+    return id_str;
   }
   auto get_type_id(clang::QualType original_qt, unsigned depth = 0)
       -> std::string {
@@ -85,7 +144,6 @@ struct TypeInterner {
       std::string spell = as_c_decl(clang::QualType(builtin_ty, 0));
       Node node;
       node.data = BuiltinType{spell};
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *templ_param_ty =
@@ -97,14 +155,12 @@ struct TypeInterner {
           .name = (templ_param_ty->getIdentifier() != nullptr
                        ? templ_param_ty->getIdentifier()->getName().str()
                        : std::string("(anon)"))};
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *ptr_ty = canon->getAs<clang::PointerType>()) {
       clang::QualType pointee_qt = ptr_ty->getPointeeType();
       Node node;
       node.data = PointerType{get_type_id(pointee_qt, depth + 1)};
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *lvalue_ref_ty =
@@ -117,20 +173,17 @@ struct TypeInterner {
       return make_pointer_to(
           get_type_id(rvalue_ref_ty->getPointeeType(), depth + 1));
     }
-    if (const auto *const_array_ty = context->getAsConstantArrayType(canon)) {
+    if (const auto *const_array_ty = as_constant_array(canon)) {
       Node node;
       node.data = FixedSizeArrayType{
           .size = const_array_ty->getSize().getZExtValue(),
           .elem = get_type_id(const_array_ty->getElementType(), depth + 1)};
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
-    if (const auto *incomplete_array_ty =
-            context->getAsIncompleteArrayType(canon)) {
+    if (const auto *incomplete_array_ty = as_incomplete_array(canon)) {
       Node node;
       node.data = UnsizedArrayType{
           get_type_id(incomplete_array_ty->getElementType(), depth + 1)};
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *func_proto_ty = canon->getAs<clang::FunctionProtoType>()) {
@@ -143,7 +196,6 @@ struct TypeInterner {
       function_type.variadic = func_proto_ty->isVariadic();
       Node node;
       node.data = std::move(function_type);
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *templ_spec_ty =
@@ -151,7 +203,7 @@ struct TypeInterner {
       TemplateSpecializationType spec;
       if (const clang::TemplateDecl *templ_decl =
               templ_spec_ty->getTemplateName().getAsTemplateDecl()) {
-        spec.name = templ_decl->getQualifiedNameAsString();
+        spec.name = qualified_name(templ_decl);
       } else {
         spec.name = printed;
       }
@@ -164,7 +216,6 @@ struct TypeInterner {
       }
       Node node;
       node.data = std::move(spec);
-      node.cdecl = printed;
       return intern(std::move(node), printed);
     }
     if (const auto *record_decl = canon->getAsCXXRecordDecl()) {
@@ -172,7 +223,7 @@ struct TypeInterner {
       if (llvm::isa<clang::ClassTemplateSpecializationDecl>(record_decl)) {
         record_name = as_c_decl(canon);
       } else {
-        record_name = record_decl->getQualifiedNameAsString();
+        record_name = qualified_name(record_decl);
       }
       if (record_decl->isCompleteDefinition() &&
           seen_records->insert(record_decl).second) {
@@ -183,12 +234,14 @@ struct TypeInterner {
     if (const auto *enum_type = canon->getAs<clang::EnumType>()) {
       const clang::EnumDecl *enum_decl = enum_type->getDecl();
       if (enum_decl->isCompleteDefinition()) {
-        return enum_decl->getQualifiedNameAsString();
+        if (seen_enums.insert(enum_decl).second) {
+          pending_enums.push_back(enum_decl);
+        }
+        return qualified_name(enum_decl);
       }
     }
     Node unknown;
     unknown.data = UnknownType{printed};
-    unknown.cdecl = printed;
     return intern(std::move(unknown), printed);
   }
 };
@@ -248,26 +301,35 @@ void emit_vftable_ptrs(clang::ASTContext &ctx, const std::string &record_name,
                        std::vector<ObjectField> &fields,
                        ObjectField &vfptr_field_template) {
   if (auto *msvctx = llvm::dyn_cast<clang::MicrosoftVTableContext>(
-          ctx.getVTableContext())) {
-    uint64_t ptr_bytes =
-        ctx.getTargetInfo().getPointerWidth(clang::LangAS::Default) /
-        kBitsPerByte;
+          interner.locked([&] { return ctx.getVTableContext(); }))) {
+    uint64_t ptr_bytes = interner.locked([&] {
+      return ctx.getTargetInfo().getPointerWidth(clang::LangAS::Default);
+    }) / kBitsPerByte;
     unsigned vf_index = 0;
-    for (const auto &offset_info : msvctx->getVFPtrOffsets(record_decl)) {
+    // Both are cached by the vtable context and stay put once computed.
+    const clang::VPtrInfoVector &offsets =
+        interner.locked([&]() -> const clang::VPtrInfoVector & {
+          return msvctx->getVFPtrOffsets(record_decl);
+        });
+    for (const auto &offset_info : offsets) {
       Node vf_node;
       vf_node.name = record_name + "__vftable_" + std::to_string(vf_index);
       VfTableType table{.original_record = record_name};
 
       uint64_t slot_index = 0;
-      const auto &vt_layout =
-          msvctx->getVFTableLayout(record_decl, offset_info->FullOffsetInMDC);
+      const clang::VTableLayout &vt_layout =
+          interner.locked([&]() -> const clang::VTableLayout & {
+            return msvctx->getVFTableLayout(record_decl,
+                                            offset_info->FullOffsetInMDC);
+          });
       for (const clang::VTableComponent &component :
            vt_layout.vtable_components()) {
         if (component.getKind() == clang::VTableComponent::CK_FunctionPointer) {
           if (const clang::FunctionDecl *func_decl =
                   component.getFunctionDecl()) {
             ObjectField row;
-            std::string fn_name = func_decl->getNameAsString();
+            std::string fn_name =
+                interner.locked([&] { return func_decl->getNameAsString(); });
             if (fn_name.empty()) {
               fn_name = "fn" + std::to_string(slot_index);
             }
@@ -289,6 +351,8 @@ void emit_vftable_ptrs(clang::ASTContext &ctx, const std::string &record_name,
       vfptr_field.type_id = interner.make_pointer_to(
           record_name + "__vftable_" + std::to_string(vf_index));
       vfptr_field.size_bytes = ptr_bytes;
+      vfptr_field.offset_bits =
+          offset_info->FullOffsetInMDC.getQuantity() * kBitsPerByte;
       fields.push_back(std::move(vfptr_field));
       ++vf_index;
     }
@@ -300,9 +364,9 @@ void emit_vftable_type(clang::ASTContext &ctx, const std::string &record_name,
                        TypeInterner &interner,
                        std::vector<Node> &synthetic_nodes,
                        std::vector<ObjectField> &fields) {
-  uint64_t ptr_bytes =
-      ctx.getTargetInfo().getPointerWidth(clang::LangAS::Default) /
-      kBitsPerByte;
+  uint64_t ptr_bytes = interner.locked([&] {
+    return ctx.getTargetInfo().getPointerWidth(clang::LangAS::Default);
+  }) / kBitsPerByte;
   Node vf_node;
   vf_node.name = record_name + "__vftable_0";
   VfTableType table;
@@ -313,7 +377,8 @@ void emit_vftable_type(clang::ASTContext &ctx, const std::string &record_name,
       continue;
     }
     ObjectField vf_entry;
-    std::string method_name = method_decl->getNameAsString();
+    std::string method_name =
+        interner.locked([&] { return method_decl->getNameAsString(); });
     if (method_name.empty()) {
       method_name = "fn" + std::to_string(slot_index);
     }
@@ -350,15 +415,20 @@ void build_bases_fields(
       continue;
     }
     ObjectField base_field;
-    base_field.name = base_decl->getQualifiedNameAsString();
+    base_field.name = interner.qualified_name(base_decl);
     base_field.is_base = true;
     base_field.is_virtual_base = base.isVirtual();
     base_field.type_id = interner.get_type_id(base.getType());
     if ((layout == nullptr) || !base_decl->isCompleteDefinition()) {
       base_field.layout_known = false;
     } else {
-      base_field.size_bytes =
-          ctx.getASTRecordLayout(base_decl).getSize().getQuantity();
+      base_field.size_bytes = interner.locked([&] {
+        return ctx.getASTRecordLayout(base_decl).getSize().getQuantity();
+      });
+      clang::CharUnits base_offset =
+          base.isVirtual() ? layout->getVBaseClassOffset(base_decl)
+                           : layout->getBaseClassOffset(base_decl);
+      base_field.offset_bits = base_offset.getQuantity() * kBitsPerByte;
     }
     fields.push_back(std::move(base_field));
     maybe_queue_record(base_decl, seen_records, worklist);
@@ -377,11 +447,15 @@ void build_member_fields(clang::ASTContext &ctx,
         field_decl->getType()->isDependentType() || (layout == nullptr);
     if (field_decl->isBitField()) {
       member_field.is_bitfield = true;
-      member_field.bit_width = field_decl->getBitWidthValue();
+      member_field.bit_width =
+          interner.locked([&] { return field_decl->getBitWidthValue(); });
     }
     if (!is_dependent) {
-      member_field.size_bytes =
-          ctx.getTypeSize(field_decl->getType()) / kBitsPerByte;
+      member_field.size_bytes = interner.locked([&] {
+        return ctx.getTypeSize(field_decl->getType());
+      }) / kBitsPerByte;
+      member_field.offset_bits =
+          layout->getFieldOffset(field_decl->getFieldIndex());
     } else {
       member_field.layout_known = false;
     }
@@ -403,10 +477,11 @@ auto build_record_node(
       record_decl->getDescribedClassTemplate() != nullptr;
   if (const auto *spec =
           llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(record_decl)) {
-    clang::QualType rec_qt = ctx.getRecordType(record_decl);
     clang::PrintingPolicy printer(ctx.getLangOpts());
     printer.SuppressTagKeyword = true;
-    rec_node.name = rec_qt.getAsString(printer);
+    rec_node.name = interner.locked([&] {
+      return ctx.getRecordType(record_decl).getAsString(printer);
+    });
     if (const clang::TemplateDecl *templ_decl =
             spec->getSpecializedTemplate()) {
       if (const auto *ctd =
@@ -414,7 +489,7 @@ auto build_record_node(
         const clang::CXXRecordDecl *pattern = ctd->getTemplatedDecl();
         maybe_queue_record(pattern, seen_records, worklist);
         if (pattern != nullptr) {
-          std::string base_name = pattern->getQualifiedNameAsString();
+          std::string base_name = interner.qualified_name(pattern);
           std::string params;
           bool first = true;
           for (const clang::NamedDecl *param_decl :
@@ -439,7 +514,7 @@ auto build_record_node(
     }
   } else if (is_primary_template) {
     if (const auto *ctd = record_decl->getDescribedClassTemplate()) {
-      std::string base_name = record_decl->getQualifiedNameAsString();
+      std::string base_name = interner.qualified_name(record_decl);
       std::string params;
       bool first = true;
       for (const clang::NamedDecl *param_decl : *ctd->getTemplateParameters()) {
@@ -462,17 +537,19 @@ auto build_record_node(
           params.empty() ? base_name : base_name + "<" + params + ">";
     }
   } else {
-    rec_node.name = record_decl->getQualifiedNameAsString();
+    rec_node.name = interner.qualified_name(record_decl);
   }
   if (rec_node.name.empty()) {
-    rec_node.name = record_decl->getQualifiedNameAsString();
+    rec_node.name = interner.qualified_name(record_decl);
   }
   if (is_primary_template) {
     obj.template_primary = true;
   }
   const clang::ASTRecordLayout *layout = nullptr;
   if (!is_primary_template) {
-    layout = &ctx.getASTRecordLayout(record_decl);
+    layout = &interner.locked([&]() -> const clang::ASTRecordLayout & {
+      return ctx.getASTRecordLayout(record_decl);
+    });
     obj.size_bytes = layout->getSize().getQuantity();
     obj.align_bytes = layout->getAlignment().getQuantity();
   } else {
@@ -507,41 +584,103 @@ auto build_record_node(
   return rec_node;
 }
 
+// Forces the lazily computed ASTContext state build_record_node reads for
+// `record_decl`, so its locked queries are mostly cache hits afterwards.
+void prepare_record_layout(clang::ASTContext &ctx,
+                           const clang::CXXRecordDecl *record_decl) {
+  if (record_decl->getDescribedClassTemplate() != nullptr ||
+      !record_decl->isCompleteDefinition()) {
+    return;
+  }
+  ctx.getRecordType(record_decl);
+  ctx.getASTRecordLayout(record_decl);
+  for (const auto &base : record_decl->bases()) {
+    const clang::CXXRecordDecl *base_decl =
+        base.getType()->getAsCXXRecordDecl();
+    if (base_decl != nullptr && base_decl->isCompleteDefinition()) {
+      ctx.getASTRecordLayout(base_decl);
+    }
+  }
+  for (const clang::FieldDecl *field_decl : record_decl->fields()) {
+    if (!field_decl->getType()->isDependentType()) {
+      ctx.getTypeInfo(field_decl->getType());
+    }
+  }
+  if (record_decl->isDynamicClass()) {
+    if (auto *msvctx = llvm::dyn_cast<clang::MicrosoftVTableContext>(
+            ctx.getVTableContext())) {
+      for (const auto &offset_info : msvctx->getVFPtrOffsets(record_decl)) {
+        msvctx->getVFTableLayout(record_decl, offset_info->FullOffsetInMDC);
+      }
+    }
+  }
+}
+
+template <typename Fn>
+void run_parallel(size_t count, unsigned threads, Fn &&task) {
+  std::atomic<size_t> next{0};
+  auto worker = [&] {
+    for (size_t i = next++; i < count; i = next++) {
+      task(i);
+    }
+  };
+  size_t helpers = std::min<size_t>(threads, count);
+  std::vector<std::thread> pool;
+  pool.reserve(helpers);
+  for (size_t i = 1; i < helpers; ++i) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+}
+
+// Output of building one record on a worker thread, merged in order later.
+struct RecordTask {
+  const clang::CXXRecordDecl *record = nullptr;
+  std::vector<Node> interned;
+  Node record_node;
+  std::vector<Node> synthetic;
+  llvm::SmallVector<const clang::CXXRecordDecl *, kWorklistInitialCapacity>
+      discovered;
+  llvm::SmallVector<const clang::EnumDecl *, kWorklistInitialCapacity> enums;
+};
+
 class DbBuildVisitor : public clang::RecursiveASTVisitor<DbBuildVisitor> {
 public:
-  explicit DbBuildVisitor(clang::ASTContext &ctx)
+  explicit DbBuildVisitor(clang::ASTContext &ctx,
+                          const BuildOptions &options = {})
       : ctx_(&ctx), db_(init_db_from_target(ctx)),
-        interner_(ctx, db_.nodes, seen_records_, worklist_) {}
+        interner_(ctx, db_.nodes, seen_records_, worklist_),
+        skip_system_headers_(options.skip_system_headers),
+        path_filter_(options.allow_paths, options.deny_paths),
+        sink_(options.sink), counters_(options.counters),
+        layout_threads_(options.layout_threads) {
+    if (options.type_ids == nullptr) {
+      owned_type_ids_ = std::make_unique<TypeIdInterner>();
+    }
+    interner_.type_ids = options.type_ids != nullptr ? options.type_ids
+                                                     : owned_type_ids_.get();
+  }
 
-  auto VisitEnumDecl(clang::EnumDecl *decl) -> bool {
-    if (decl == nullptr || !decl->isCompleteDefinition()) {
+  // Filtered-out subtrees are pruned here rather than in the Visit* hooks so
+  // their members are never walked; records and enums they define are still
+  // emitted lazily when referenced from an allowed declaration.
+  auto TraverseDecl(clang::Decl *decl) -> bool {
+    if (decl != nullptr && !llvm::isa<clang::TranslationUnitDecl>(decl) &&
+        !is_traversal_allowed(decl)) {
       return true;
     }
-    std::string name = decl->getQualifiedNameAsString();
-    if (emitted_names_.contains(name)) {
+    return clang::RecursiveASTVisitor<DbBuildVisitor>::TraverseDecl(decl);
+  }
+
+  auto VisitEnumDecl(clang::EnumDecl *decl) -> bool {
+    if (decl == nullptr || !decl->isCompleteDefinition()) {
       return true;
     }
-    Node node;
-    node.name = name;
-    EnumType enum_data;
-    clang::QualType eqt(decl->getTypeForDecl(), 0);
-    enum_data.size_bytes = ctx_->getTypeSize(eqt) / kBitsPerByte;
-    enum_data.align_bytes = ctx_->getTypeAlign(eqt) / kBitsPerByte;
-    if (const clang::Type *under_t =
-            decl->getIntegerType().getTypePtrOrNull()) {
-      clang::QualType ut_qt(under_t, 0);
-      enum_data.underlying_type = interner_.get_type_id(ut_qt);
-    }
-    for (const clang::EnumConstantDecl *enumerator : decl->enumerators()) {
-      llvm::APSInt val = enumerator->getInitVal();
-      llvm::SmallString<kSmallStringBuffer> buffer;
-      val.toString(buffer, kDecimalBase);
-      enum_data.enumerators.emplace_back(enumerator->getNameAsString(),
-                                         buffer.str().str());
-    }
-    node.data = std::move(enum_data);
-    db_.nodes.push_back(std::move(node));
-    emitted_names_.insert(std::move(name));
+    emit_enum(decl);
+    flush_nodes();
     return true;
   }
 
@@ -554,6 +693,12 @@ public:
     if (!decl->isCompleteDefinition() && !is_primary_template) {
       return true;
     }
+    if (layout_threads_ > 1) {
+      if (processed_.insert(decl).second) {
+        roots_.push_back(decl);
+      }
+      return true;
+    }
     ensure_record_emitted(decl);
     return true;
   }
@@ -584,36 +729,244 @@ public:
       Node rec_node =
           build_record_node(*ctx_, record_decl, interner_, seen_records_,
                             worklist_, synthetic_nodes);
-      if (emitted_names_.insert(rec_node.name).second) {
+      if (mark_emitted(rec_node.name)) {
         db_.nodes.push_back(std::move(rec_node));
+        count_record();
       }
     }
     for (auto &synthetic : synthetic_nodes) {
-      if (emitted_names_.insert(synthetic.name).second) {
+      if (mark_emitted(synthetic.name)) {
         db_.nodes.push_back(std::move(synthetic));
       }
     }
+    drain_pending_enums();
+    flush_nodes();
+  }
+
+  void begin() {
+    if (sink_ != nullptr) {
+      sink_->begin(db_);
+    }
   }
 
   auto build() -> TypeDb {
+    if (layout_threads_ > 1) {
+      emit_parallel();
+    }
+    drain_pending_enums();
+    flush_nodes();
+    if (sink_ != nullptr) {
+      sink_->end();
+    }
     db_.build_indices();
     return std::move(db_);
   }
 
 private:
+  // Two-phase variant of ensure_record_emitted over all collected roots. Each
+  // round serially forces the layouts of the pending records, builds their
+  // nodes on worker threads with private interners, then merges the results
+  // in pending order; records discovered along the way form the next round.
+  void emit_parallel() {
+    llvm::SmallVector<const clang::CXXRecordDecl *, kWorklistInitialCapacity>
+        pending;
+    for (const clang::CXXRecordDecl *root : roots_) {
+      maybe_queue_record(root, seen_records_, pending);
+      if (const auto *ctd = root->getDescribedClassTemplate()) {
+        maybe_queue_record(ctd->getTemplatedDecl(), seen_records_, pending);
+      }
+    }
+    ctx_->getVTableContext();
+    std::mutex type_mutex;
+    while (!pending.empty()) {
+      for (const clang::CXXRecordDecl *record_decl : pending) {
+        prepare_record_layout(*ctx_, record_decl);
+      }
+      std::vector<RecordTask> tasks(pending.size());
+      for (size_t i = 0; i < pending.size(); ++i) {
+        tasks[i].record = pending[i];
+      }
+      pending.clear();
+      run_parallel(tasks.size(), layout_threads_, [&](size_t i) {
+        build_record_task(tasks[i], type_mutex);
+      });
+      for (RecordTask &task : tasks) {
+        merge_record_task(task, pending);
+      }
+      drain_pending_enums();
+      flush_nodes();
+    }
+  }
+
+  void build_record_task(RecordTask &task, std::mutex &type_mutex) const {
+    llvm::DenseSet<const clang::CXXRecordDecl *> seen;
+    seen.insert(task.record);
+    TypeInterner local(*ctx_, task.interned, seen, task.discovered);
+    local.type_ids = interner_.type_ids;
+    local.type_mutex = &type_mutex;
+    task.record_node = build_record_node(*ctx_, task.record, local, seen,
+                                         task.discovered, task.synthetic);
+    task.enums = std::move(local.pending_enums);
+  }
+
+  void merge_record_task(
+      RecordTask &task,
+      llvm::SmallVector<const clang::CXXRecordDecl *, kWorklistInitialCapacity>
+          &pending) {
+    for (Node &node : task.interned) {
+      if (interner_.mark_interned(node.name)) {
+        db_.nodes.push_back(std::move(node));
+      }
+    }
+    if (mark_emitted(task.record_node.name)) {
+      db_.nodes.push_back(std::move(task.record_node));
+      count_record();
+    }
+    for (Node &synthetic : task.synthetic) {
+      if (mark_emitted(synthetic.name)) {
+        db_.nodes.push_back(std::move(synthetic));
+      }
+    }
+    for (const clang::CXXRecordDecl *record_decl : task.discovered) {
+      maybe_queue_record(record_decl, seen_records_, pending);
+    }
+    for (const clang::EnumDecl *enum_decl : task.enums) {
+      if (interner_.seen_enums.insert(enum_decl).second) {
+        interner_.pending_enums.push_back(enum_decl);
+      }
+    }
+  }
+
+  void emit_enum(const clang::EnumDecl *decl) {
+    std::string name = decl->getQualifiedNameAsString();
+    if (!mark_emitted(name)) {
+      return;
+    }
+    Node node;
+    node.name = name;
+    EnumType enum_data;
+    clang::QualType eqt(decl->getTypeForDecl(), 0);
+    enum_data.size_bytes = ctx_->getTypeSize(eqt) / kBitsPerByte;
+    enum_data.align_bytes = ctx_->getTypeAlign(eqt) / kBitsPerByte;
+    if (const clang::Type *under_t =
+            decl->getIntegerType().getTypePtrOrNull()) {
+      clang::QualType ut_qt(under_t, 0);
+      enum_data.underlying_type = interner_.get_type_id(ut_qt);
+      enum_data.is_signed = ut_qt->isSignedIntegerOrEnumerationType();
+    }
+    for (const clang::EnumConstantDecl *enumerator : decl->enumerators()) {
+      // Sign- or zero-extends according to the enumerator's own signedness.
+      llvm::APSInt val = enumerator->getInitVal().extOrTrunc(kEnumValueBits);
+      enum_data.enumerators.push_back(
+          Enumerator{.name = enumerator->getNameAsString(),
+                     .value = val.getZExtValue()});
+    }
+    enum_data.build_value_order();
+    node.data = std::move(enum_data);
+    db_.nodes.push_back(std::move(node));
+  }
+
+  auto mark_emitted(const std::string &name) -> bool {
+    if (emitted_names_.contains(name)) {
+      return false;
+    }
+    emitted_names_.insert(interner_.type_ids->canonical(name));
+    return true;
+  }
+
+  void count_record() {
+    if (counters_ != nullptr) {
+      BuildCounters::bump(counters_->records);
+    }
+  }
+
+  // Counts the nodes added since the last flush_nodes call.
+  void count_new_nodes() {
+    if (counters_ != nullptr) {
+      BuildCounters::bump(counters_->nodes, db_.nodes.size() - counted_nodes_);
+    }
+    counted_nodes_ = db_.nodes.size();
+  }
+
+  void flush_nodes() {
+    count_new_nodes();
+    if (sink_ == nullptr) {
+      return;
+    }
+    for (Node &node : db_.nodes) {
+      sink_->node(std::move(node));
+    }
+    db_.nodes.clear();
+    counted_nodes_ = 0;
+  }
+
+  void drain_pending_enums() {
+    while (!interner_.pending_enums.empty()) {
+      const clang::EnumDecl *decl = interner_.pending_enums.pop_back_val();
+      emit_enum(decl);
+    }
+  }
+
+  auto is_traversal_allowed(const clang::Decl *decl) -> bool {
+    if (!skip_system_headers_ && path_filter_.empty()) {
+      return true;
+    }
+    const clang::SourceManager &sm = ctx_->getSourceManager();
+    clang::SourceLocation loc = sm.getExpansionLoc(decl->getLocation());
+    if (loc.isInvalid()) {
+      return true;
+    }
+    auto [it, inserted] = file_allowed_.try_emplace(sm.getFileID(loc), true);
+    if (inserted) {
+      it->second = is_file_allowed(sm, loc);
+    }
+    return it->second;
+  }
+
+  auto is_file_allowed(const clang::SourceManager &sm,
+                       clang::SourceLocation loc) const -> bool {
+    if (skip_system_headers_ && sm.isInSystemHeader(loc)) {
+      return false;
+    }
+    if (path_filter_.empty()) {
+      return true;
+    }
+    // Relative names are relative to the compilation's working directory,
+    // not the process's.
+    llvm::SmallString<256> path(sm.getFilename(loc));
+    sm.getFileManager().makeAbsolutePath(path);
+    return path_filter_.allows(path);
+  }
+
   clang::ASTContext *ctx_;
   TypeDb db_;
   llvm::DenseSet<const clang::CXXRecordDecl *> seen_records_;
   llvm::DenseSet<const clang::CXXRecordDecl *> processed_;
   llvm::SmallVector<const clang::CXXRecordDecl *, kWorklistInitialCapacity>
       worklist_;
+  // Only set when BuildOptions::type_ids is not; freed with the build.
+  std::unique_ptr<TypeIdInterner> owned_type_ids_;
   TypeInterner interner_;
-  std::unordered_set<std::string> emitted_names_;
+  llvm::DenseSet<llvm::StringRef> emitted_names_;
+  bool skip_system_headers_;
+  PathFilter path_filter_;
+  llvm::DenseMap<clang::FileID, bool> file_allowed_;
+  NodeSink *sink_;
+  BuildCounters *counters_;
+  size_t counted_nodes_ = 0;
+  unsigned layout_threads_;
+  std::vector<const clang::CXXRecordDecl *> roots_;
 };
 } // namespace
 
 auto build_type_db(clang::ASTContext &ctx) -> TypeDb {
-  DbBuildVisitor visitor(ctx);
+  return build_type_db(ctx, BuildOptions{});
+}
+
+auto build_type_db(clang::ASTContext &ctx, const BuildOptions &options)
+    -> TypeDb {
+  DbBuildVisitor visitor(ctx, options);
+  visitor.begin();
   visitor.TraverseDecl(ctx.getTranslationUnitDecl());
   return visitor.build();
 }
@@ -1,13 +1,46 @@
 #pragma once
 #include "typedb.h"
+#include "typedb_interner.h"
+#include "typedb_metrics.h"
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/DeclCXX.h>
+#include <string>
 #include <vector>
 
 namespace me3::typedb {
 
+struct BuildOptions {
+  // Skip traversal of declarations located in system headers.
+  bool skip_system_headers = false;
+  // Directories or files; when non-empty, only declarations in files under
+  // them are traversed. Matched as described for PathFilter.
+  std::vector<std::string> allow_paths;
+  // Directories or files whose declarations are never traversed. Wins over
+  // allow_paths.
+  std::vector<std::string> deny_paths;
+  // When set, finished nodes are handed to the sink after each record (with
+  // its vftables) or enum instead of being kept, and the returned TypeDb
+  // holds no nodes. Only the dedup sets stay resident.
+  NodeSink *sink = nullptr;
+  // When greater than one, records are collected during traversal, their
+  // layouts forced serially, and their nodes built on this many threads.
+  // Output is deterministic but ordered differently from the serial mode.
+  unsigned layout_threads = 0;
+  // Interner for type id strings, so that the dedup sets of concurrent builds
+  // share one copy of every id; the returned nodes keep their own. Must
+  // outlive the builds using it; when unset, each build uses its own, freed
+  // when the build returns.
+  TypeIdInterner *type_ids = nullptr;
+  // Progress counters of the calling thread, bumped as records and nodes are
+  // built.
+  BuildCounters *counters = nullptr;
+};
+
 auto build_type_db(clang::ASTContext &ctx) -> TypeDb;
 
+auto build_type_db(clang::ASTContext &ctx, const BuildOptions &options)
+    -> TypeDb;
+
 auto build_type_db(clang::ASTContext &ctx,
                    const std::vector<const clang::CXXRecordDecl *> &records)
     -> TypeDb;
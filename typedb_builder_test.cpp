@@ -0,0 +1,107 @@
+#include "typedb.h"
+#include "typedb_api.h"
+#include "typedb_builder.h"
+#include "typedb_json.h"
+#include "typedb_test.h"
+#include <llvm/Support/FormatVariadic.h>
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace me3::typedb;
+
+namespace {
+
+constexpr int kRecordCount = 48;
+
+// Virtual bases and methods, templates, arrays, bitfields and enums, repeated
+// so that several records are built on each thread at once.
+auto sample_code() -> std::string {
+  std::string code = R"cpp(
+enum class Color : unsigned char { Red, Green };
+struct Base {
+  virtual ~Base();
+  virtual int get() const;
+  int id;
+};
+template <typename T> struct Box {
+  T value;
+  T *next;
+};
+)cpp";
+  for (int i = 0; i < kRecordCount; ++i) {
+    code += llvm::formatv(R"cpp(
+enum Kind{0} {{ Kind{0}A, Kind{0}B = {0} };
+struct Derived{0} : Base {{
+  int get() const override;
+  virtual void extra{0}();
+  Box<int[{1}]> boxed;
+  Box<Derived{0} *> chain;
+  unsigned flags : {1};
+  Kind{0} kind;
+  Color color;
+  double values[{1}][2];
+};
+)cpp",
+                          i, i % 7 + 1)
+                .str();
+  }
+  return code;
+}
+
+auto build(const std::string &code, unsigned layout_threads)
+    -> std::optional<TypeDb> {
+  std::optional<TypeDb> built;
+  BuildOptions options;
+  options.layout_threads = layout_threads;
+  bool compiled = build_from_code(
+      code, "input.cpp", default_compile_args(),
+      [&](TypeDb &&type_db) { built = std::move(type_db); }, options);
+  TYPEDB_CHECK(compiled);
+  TYPEDB_CHECK(built.has_value());
+  return built;
+}
+
+// The parallel build orders nodes differently, so compare them by name.
+auto sorted_json(TypeDb db) -> std::string {
+  std::sort(db.nodes.begin(), db.nodes.end(),
+            [](const Node &a, const Node &b) { return a.name < b.name; });
+  db.build_indices();
+  return llvm::formatv("{0:2}", typedb_to_json(db)).str();
+}
+
+void test_parallel_matches_serial() {
+  std::string code = sample_code();
+  std::optional<TypeDb> serial = build(code, 1);
+  if (!serial) {
+    return;
+  }
+  TYPEDB_CHECK(serial->nodes.size() > size_t{kRecordCount} * 2);
+  std::string expected = sorted_json(std::move(*serial));
+  for (int round = 0; round < 4; ++round) {
+    std::optional<TypeDb> parallel = build(code, 4);
+    if (parallel) {
+      TYPEDB_CHECK_EQ(sorted_json(std::move(*parallel)), expected);
+    }
+  }
+}
+
+void test_parallel_is_deterministic() {
+  std::string code = sample_code();
+  std::optional<TypeDb> first = build(code, 4);
+  std::optional<TypeDb> second = build(code, 4);
+  if (!first || !second) {
+    return;
+  }
+  TYPEDB_CHECK_EQ(llvm::formatv("{0}", typedb_to_json(*first)).str(),
+                  llvm::formatv("{0}", typedb_to_json(*second)).str());
+}
+
+} // namespace
+
+auto main() -> int {
+  test_parallel_matches_serial();
+  test_parallel_is_deterministic();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,114 @@
+#include "typedb.h"
+#include "typedb_test.h"
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+using namespace me3::typedb;
+
+namespace {
+
+void add_node(TypeDb &db, std::string name, NodeVariant data,
+              std::string cdecl = {}) {
+  Node node;
+  node.name = std::move(name);
+  node.cdecl = std::move(cdecl);
+  node.data = std::move(data);
+  db.nodes.push_back(std::move(node));
+}
+
+// Kinds interleaved, so that per-kind order differs from insertion order.
+auto sample_db() -> TypeDb {
+  TypeDb db;
+  add_node(db, "int", BuiltinType{"int"});
+  add_node(db, "A", ObjectType{});
+  add_node(db, "int *", PointerType{"int"});
+  add_node(db, "E", EnumType{}, "enum E");
+  add_node(db, "B", ObjectType{});
+  add_node(db, "char", BuiltinType{"char"});
+  add_node(db, "A::vftable", VfTableType{});
+  add_node(db, "int[2]", FixedSizeArrayType{.size = 2, .elem = "int"});
+  add_node(db, "C", ObjectType{});
+  add_node(db, "?", UnknownType{"?"});
+  db.build_indices();
+  return db;
+}
+
+// "name/cdecl/kind " for every node, through the generic walk.
+auto all_nodes(const TypeDb &db) -> std::string {
+  std::string seen;
+  db.for_each_node([&](const std::string &name, const std::string &cdecl,
+                       const auto &data) {
+    using Kind = std::decay_t<decltype(data)>;
+    seen += name + "/" + cdecl + "/" +
+            std::to_string(node_kind_index_v<Kind>) + " ";
+  });
+  return seen;
+}
+
+// The same entries through for_each_node<Kind>, one kind after another.
+template <size_t... Indices>
+auto by_kind(const TypeDb &db, std::index_sequence<Indices...> /*unused*/)
+    -> std::string {
+  std::string seen;
+  auto walk = [&](auto tag) {
+    using Kind = typename decltype(tag)::type;
+    db.for_each_node<Kind>([&](const std::string &name,
+                               const std::string &cdecl,
+                               const Kind & /*data*/) {
+      seen += name + "/" + cdecl + "/" +
+              std::to_string(node_kind_index_v<Kind>) + " ";
+    });
+  };
+  (walk(std::type_identity<std::variant_alternative_t<Indices, NodeVariant>>{}),
+   ...);
+  return seen;
+}
+
+auto by_kind(const TypeDb &db) -> std::string {
+  return by_kind(db,
+                 std::make_index_sequence<std::variant_size_v<NodeVariant>>{});
+}
+
+void test_walks_match_across_layouts() {
+  TypeDb db = sample_db();
+  std::string rows = all_nodes(db);
+  std::string rows_by_kind = by_kind(db);
+  TYPEDB_CHECK_EQ(rows, std::string("int//0 A//7 int *//2 E/enum E/8 B//7 "
+                                    "char//0 A::vftable//9 int[2]//3 C//7 "
+                                    "?//10 "));
+  TYPEDB_CHECK_EQ(rows_by_kind,
+                  std::string("int//0 char//0 int *//2 int[2]//3 A//7 B//7 "
+                              "C//7 E/enum E/8 A::vftable//9 ?//10 "));
+
+  db.columnize();
+  TYPEDB_CHECK(db.is_columnar());
+  TYPEDB_CHECK(db.nodes.empty());
+  TYPEDB_CHECK_EQ(db.node_count(), size_t{10});
+  TYPEDB_CHECK_EQ(all_nodes(db), rows);
+  TYPEDB_CHECK_EQ(by_kind(db), rows_by_kind);
+  TYPEDB_CHECK_EQ(db.column<ObjectType>().names.size(), size_t{3});
+}
+
+void test_index_after_columnize() {
+  TypeDb db = sample_db();
+  db.columnize();
+  TYPEDB_CHECK_EQ(db.node_index.at("C"), size_t{8});
+  db.build_indices();
+  TYPEDB_CHECK_EQ(db.node_index.size(), size_t{10});
+  TYPEDB_CHECK_EQ(db.node_index.at("C"), size_t{8});
+  TYPEDB_CHECK_EQ(db.node_index.at("?"), size_t{9});
+  TYPEDB_CHECK_EQ(static_cast<unsigned>(db.slots.at(8).kind),
+                  static_cast<unsigned>(node_kind_index_v<ObjectType>));
+  TYPEDB_CHECK_EQ(db.slots.at(8).row, 2U);
+}
+
+} // namespace
+
+auto main() -> int {
+  test_walks_match_across_layouts();
+  test_index_after_columnize();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,301 @@
+#include "typedb_cpp.h"
+#include <algorithm>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace me3::typedb {
+namespace {
+
+constexpr uint64_t kBitsPerByte = 8;
+
+// Maps an arbitrary C++ spelling (qualified names, template arguments,
+// operators) onto an identifier that is neither reserved nor a keyword.
+auto sanitize_identifier(llvm::StringRef spelling) -> std::string {
+  std::string result;
+  result.reserve(spelling.size());
+  bool after_underscore = true; // also drops leading underscores
+  for (char c : spelling) {
+    if (llvm::isAlnum(c)) {
+      result.push_back(c);
+      after_underscore = false;
+    } else if (!after_underscore) {
+      result.push_back('_');
+      after_underscore = true;
+    }
+  }
+  if (result.empty() || llvm::isDigit(result.front())) {
+    result.insert(0, "n_");
+  }
+  if (result == "operator" || result == "new" || result == "delete") {
+    result.push_back('_');
+  }
+  return result;
+}
+
+// Hands out unique sanitized identifiers within one C++ scope.
+class NameScope {
+public:
+  void reserve(llvm::StringRef name) { taken_.insert(name); }
+
+  auto claim(llvm::StringRef spelling) -> std::string {
+    std::string base = sanitize_identifier(spelling);
+    std::string name = base;
+    for (unsigned suffix = 2; !taken_.insert(name).second; ++suffix) {
+      name = base + "_" + std::to_string(suffix);
+    }
+    return name;
+  }
+
+private:
+  llvm::StringSet<> taken_;
+};
+
+// Portable spelling of a builtin of the given size, if it has one.
+auto builtin_member_type(std::string_view name, uint64_t size_bytes)
+    -> std::optional<std::string> {
+  // Builtin node names are canonical spellings, cv-qualifiers included.
+  for (bool stripped = true; stripped;) {
+    stripped = false;
+    for (std::string_view qualifier : {"const ", "volatile "}) {
+      if (name.starts_with(qualifier)) {
+        name.remove_prefix(qualifier.size());
+        stripped = true;
+      }
+    }
+  }
+  if (name == "bool" && size_bytes == 1) {
+    return "bool";
+  }
+  if (name == "char" && size_bytes == 1) {
+    return "char";
+  }
+  if (name == "float" && size_bytes == 4) {
+    return "float";
+  }
+  if ((name == "double" || name == "long double") && size_bytes == 8) {
+    return "double";
+  }
+  if (name.contains("float") || name.contains("double") ||
+      name.contains("int128")) {
+    return std::nullopt;
+  }
+  bool is_integer = name.contains("char") || name.contains("short") ||
+                    name.contains("int") || name.contains("long");
+  if (!is_integer || (size_bytes != 1 && size_bytes != 2 && size_bytes != 4 &&
+                      size_bytes != 8)) {
+    return std::nullopt;
+  }
+  bool is_unsigned = name.starts_with("unsigned") || name == "wchar_t" ||
+                     name.starts_with("char");
+  return std::string(is_unsigned ? "std::uint" : "std::int") +
+         std::to_string(size_bytes * kBitsPerByte) + "_t";
+}
+
+class CppHeaderWriter {
+public:
+  CppHeaderWriter(const TypeDb &type_db, llvm::raw_ostream &out)
+      : type_db_(type_db), out_(out) {
+    type_db_.for_each_node<BuiltinType>(
+        [&](const std::string &name, const std::string & /*cdecl*/,
+            const BuiltinType & /*data*/) { builtins_.insert(name); });
+    type_db_.for_each_node<PointerType>(
+        [&](const std::string &name, const std::string & /*cdecl*/,
+            const PointerType & /*data*/) { pointers_.insert(name); });
+    type_db_.for_each_node<EnumType>([&](const std::string &name,
+                                         const std::string & /*cdecl*/,
+                                         const EnumType &data) {
+      enum_underlying_.emplace(name, data.underlying_type);
+    });
+  }
+
+  void write(const CppHeaderOptions &options) {
+    out_ << "// Generated by me3-typedb-parser";
+    if (!type_db_.triple.empty()) {
+      out_ << " for " << type_db_.triple;
+    }
+    out_ << ". Do not edit.\n"
+         << "#pragma once\n"
+         << "#include <cstddef>\n"
+         << "#include <cstdint>\n\n"
+         << "namespace " << options.namespace_name << " {\n\n";
+    if (type_db_.pointer_width_bits != 0) {
+      out_ << "static_assert(sizeof(void *) == "
+           << type_db_.pointer_width_bits / kBitsPerByte
+           << ", \"layouts were generated for a different pointer "
+              "width\");\n\n";
+    }
+    type_db_.for_each_node<VfTableType>(
+        [&](const std::string &name, const std::string & /*cdecl*/,
+            const VfTableType &data) { write_vftable(name, data); });
+    type_db_.for_each_node<ObjectType>(
+        [&](const std::string &name, const std::string & /*cdecl*/,
+            const ObjectType &data) { write_record(name, data); });
+    out_ << "} // namespace " << options.namespace_name << "\n";
+  }
+
+private:
+  void write_vftable(const std::string &name, const VfTableType &table) {
+    std::string struct_name = top_level_.claim(name);
+    NameScope slots;
+    out_ << "// " << name << " (" << table.original_record << ")\n"
+         << "struct " << struct_name << " {\n"
+         << "  enum class slot : std::size_t {\n";
+    for (size_t index = 0; index < table.fields.size(); ++index) {
+      std::string_view slot_name = table.fields[index].name;
+      std::string identifier =
+          slots.claim(slot_name.starts_with("~") ? "dtor" : slot_name);
+      out_ << "    " << identifier << " = " << index << ",\n";
+    }
+    out_ << "  };\n"
+         << "  static constexpr std::size_t slot_count = "
+         << table.fields.size() << ";\n"
+         << "};\n\n";
+  }
+
+  // Member type for fields that can be spelled portably, otherwise none and
+  // the field is emitted as raw bytes.
+  auto member_type(const ObjectField &field) const
+      -> std::optional<std::string> {
+    if (field.is_base || field.is_bitfield) {
+      return std::nullopt;
+    }
+    if (pointers_.contains(field.type_id) &&
+        field.size_bytes * kBitsPerByte ==
+            static_cast<uint64_t>(type_db_.pointer_width_bits)) {
+      return "void *";
+    }
+    const std::string *builtin = &field.type_id;
+    if (auto underlying = enum_underlying_.find(field.type_id);
+        underlying != enum_underlying_.end()) {
+      builtin = &underlying->second;
+    }
+    if (!builtins_.contains(*builtin)) {
+      return std::nullopt;
+    }
+    return builtin_member_type(*builtin, field.size_bytes);
+  }
+
+  void write_record(const std::string &name, const ObjectType &record) {
+    if (record.template_primary || record.layout_dependent ||
+        record.size_bytes == 0) {
+      return;
+    }
+    for (const ObjectField &field : record.fields) {
+      if (!field.layout_known || !field.offset_bits) {
+        return;
+      }
+    }
+
+    std::string struct_name = top_level_.claim(name);
+    NameScope members;
+    members.reserve("size");
+    members.reserve("align");
+    std::vector<std::string> identifiers;
+    identifiers.reserve(record.fields.size());
+    for (const ObjectField &field : record.fields) {
+      identifiers.push_back(
+          members.claim(field.is_base ? "base_" + field.name : field.name));
+    }
+
+    std::vector<size_t> order(record.fields.size());
+    for (size_t index = 0; index < order.size(); ++index) {
+      order[index] = index;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return *record.fields[lhs].offset_bits < *record.fields[rhs].offset_bits;
+    });
+
+    out_ << "// " << name << "\n"
+         << "#pragma pack(push, 1)\n"
+         << "struct alignas(" << record.align_bytes << ") " << struct_name
+         << " {\n"
+         << "  static constexpr std::size_t size = " << record.size_bytes
+         << ";\n"
+         << "  static constexpr std::size_t align = " << record.align_bytes
+         << ";\n";
+    for (size_t index : order) {
+      const ObjectField &field = record.fields[index];
+      const std::string &identifier = identifiers[index];
+      out_ << "  static constexpr std::size_t offset_of_" << identifier
+           << " = " << *field.offset_bits / kBitsPerByte << ";\n";
+      if (field.is_bitfield && field.bit_width) {
+        out_ << "  static constexpr unsigned bit_offset_of_" << identifier
+             << " = " << *field.offset_bits % kBitsPerByte << ";\n"
+             << "  static constexpr unsigned bit_width_of_" << identifier
+             << " = " << *field.bit_width << ";\n";
+      }
+    }
+    out_ << "\n";
+
+    // Lay out members front to back. Bitfields, empty bases and members
+    // overlapping an earlier one (unions) only get their constants; the
+    // bytes they occupy are covered by padding or the earlier member.
+    std::vector<size_t> typed_members;
+    uint64_t cursor = 0;
+    for (size_t index : order) {
+      const ObjectField &field = record.fields[index];
+      uint64_t offset = *field.offset_bits / kBitsPerByte;
+      if (field.is_bitfield || field.size_bytes == 0 || offset < cursor ||
+          offset + field.size_bytes > record.size_bytes) {
+        continue;
+      }
+      write_padding(cursor, offset, members);
+      std::optional<std::string> type = member_type(field);
+      if (type) {
+        out_ << "  " << *type << (std::string_view(*type).ends_with("*") ? ""
+                                                                        : " ")
+             << identifiers[index] << ";\n";
+        typed_members.push_back(index);
+      } else {
+        out_ << "  std::byte " << identifiers[index] << "[" << field.size_bytes
+             << "];\n";
+      }
+      cursor = offset + field.size_bytes;
+    }
+    write_padding(cursor, record.size_bytes, members);
+    out_ << "};\n"
+         << "#pragma pack(pop)\n"
+         << "static_assert(sizeof(" << struct_name << ") == " << struct_name
+         << "::size);\n"
+         << "static_assert(alignof(" << struct_name << ") == " << struct_name
+         << "::align);\n";
+    for (size_t index : typed_members) {
+      out_ << "static_assert(offsetof(" << struct_name << ", "
+           << identifiers[index] << ") == " << struct_name << "::offset_of_"
+           << identifiers[index] << ");\n";
+    }
+    out_ << "\n";
+  }
+
+  void write_padding(uint64_t &cursor, uint64_t offset, NameScope &members) {
+    if (offset > cursor) {
+      out_ << "  std::byte " << members.claim("pad") << "[" << offset - cursor
+           << "];\n";
+      cursor = offset;
+    }
+  }
+
+  const TypeDb &type_db_;
+  llvm::raw_ostream &out_;
+  NameScope top_level_;
+  std::unordered_set<std::string> builtins_;
+  std::unordered_set<std::string> pointers_;
+  std::unordered_map<std::string, std::string> enum_underlying_;
+};
+
+} // namespace
+
+void typedb_to_cpp_header(const TypeDb &type_db, llvm::raw_ostream &out,
+                          const CppHeaderOptions &options) {
+  CppHeaderWriter(type_db, out).write(options);
+}
+
+} // namespace me3::typedb
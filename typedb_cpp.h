@@ -0,0 +1,22 @@
+#pragma once
+#include "typedb.h"
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+
+namespace me3::typedb {
+
+struct CppHeaderOptions {
+  // Namespace wrapping every generated declaration.
+  std::string namespace_name = "me3::layout";
+};
+
+// Writes a self-contained C++17 header describing the layouts in `type_db`.
+// Every record with a known layout becomes a packed struct carrying its
+// size, alignment and per-field offsets as constexpr members, with explicit
+// padding and static_asserts guarding them. Every vftable becomes a struct
+// with a `slot` enum of virtual function indices. Field types that are not
+// builtins, enums or pointers are emitted as byte arrays.
+void typedb_to_cpp_header(const TypeDb &type_db, llvm::raw_ostream &out,
+                          const CppHeaderOptions &options = {});
+
+} // namespace me3::typedb
@@ -0,0 +1,169 @@
+#include "typedb.h"
+#include "typedb_cpp.h"
+#include "typedb_test.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto make_node(std::string name, NodeVariant data) -> Node {
+  Node node;
+  node.name = std::move(name);
+  node.data = std::move(data);
+  return node;
+}
+
+auto make_field(std::string name, std::string type_id, uint64_t size_bytes,
+                uint64_t offset_bytes) -> ObjectField {
+  ObjectField field;
+  field.name = std::move(name);
+  field.type_id = std::move(type_id);
+  field.size_bytes = size_bytes;
+  field.offset_bits = offset_bytes * 8;
+  return field;
+}
+
+auto header_for(std::vector<Node> nodes) -> std::string {
+  TypeDb db;
+  db.triple = "x86_64-pc-windows-msvc";
+  db.pointer_width_bits = 64;
+  db.nodes = std::move(nodes);
+  db.build_indices();
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  typedb_to_cpp_header(db, out);
+  return out.str();
+}
+
+auto contains(const std::string &text, llvm::StringRef needle) -> bool {
+  return llvm::StringRef(text).contains(needle);
+}
+
+// One record with a single member of builtin `type_id`; returns the line
+// declaring it.
+auto member_line(const std::string &type_id, uint64_t size_bytes)
+    -> std::string {
+  ObjectType record;
+  record.size_bytes = size_bytes;
+  record.align_bytes = size_bytes;
+  record.fields.push_back(make_field("m", type_id, size_bytes, 0));
+  std::vector<Node> nodes;
+  nodes.push_back(make_node(type_id, BuiltinType{type_id}));
+  nodes.push_back(make_node("S", std::move(record)));
+  std::string header = header_for(std::move(nodes));
+  llvm::StringRef rest(header);
+  while (!rest.empty()) {
+    auto [line, tail] = rest.split('\n');
+    std::string byte_array = " m[" + std::to_string(size_bytes) + "];";
+    if (line.endswith(" m;") || line.endswith(byte_array)) {
+      return line.trim().str();
+    }
+    rest = tail;
+  }
+  return {};
+}
+
+void test_builtin_members() {
+  TYPEDB_CHECK_EQ(member_line("unsigned int", 4),
+                  std::string("std::uint32_t m;"));
+  TYPEDB_CHECK_EQ(member_line("int", 4), std::string("std::int32_t m;"));
+  TYPEDB_CHECK_EQ(member_line("long long", 8), std::string("std::int64_t m;"));
+  TYPEDB_CHECK_EQ(member_line("signed char", 1), std::string("std::int8_t m;"));
+  TYPEDB_CHECK_EQ(member_line("char", 1), std::string("char m;"));
+  TYPEDB_CHECK_EQ(member_line("wchar_t", 2), std::string("std::uint16_t m;"));
+  TYPEDB_CHECK_EQ(member_line("char16_t", 2),
+                  std::string("std::uint16_t m;"));
+  TYPEDB_CHECK_EQ(member_line("float", 4), std::string("float m;"));
+  TYPEDB_CHECK_EQ(member_line("__int128", 16),
+                  std::string("std::byte m[16];"));
+}
+
+void test_cv_qualified_builtins() {
+  TYPEDB_CHECK_EQ(member_line("const unsigned int", 4),
+                  std::string("std::uint32_t m;"));
+  TYPEDB_CHECK_EQ(member_line("volatile unsigned char", 1),
+                  std::string("std::uint8_t m;"));
+  TYPEDB_CHECK_EQ(member_line("const volatile unsigned short", 2),
+                  std::string("std::uint16_t m;"));
+  TYPEDB_CHECK_EQ(member_line("volatile const unsigned long long", 8),
+                  std::string("std::uint64_t m;"));
+  TYPEDB_CHECK_EQ(member_line("const int", 4), std::string("std::int32_t m;"));
+  TYPEDB_CHECK_EQ(member_line("const char", 1), std::string("char m;"));
+  TYPEDB_CHECK_EQ(member_line("const wchar_t", 2),
+                  std::string("std::uint16_t m;"));
+  TYPEDB_CHECK_EQ(member_line("const bool", 1), std::string("bool m;"));
+  TYPEDB_CHECK_EQ(member_line("volatile double", 8),
+                  std::string("double m;"));
+}
+
+void test_record_layout() {
+  ObjectType record;
+  record.size_bytes = 24;
+  record.align_bytes = 8;
+  record.fields.push_back(make_field("flag", "bool", 1, 0));
+  record.fields.push_back(make_field("next", "Node *", 8, 8));
+  ObjectField bits = make_field("bits", "unsigned int", 4, 16);
+  bits.offset_bits = 16 * 8 + 3;
+  bits.bit_width = 5;
+  bits.is_bitfield = true;
+  record.fields.push_back(std::move(bits));
+  record.fields.push_back(make_field("color", "Color", 4, 20));
+
+  EnumType color;
+  color.size_bytes = 4;
+  color.align_bytes = 4;
+  color.underlying_type = "unsigned int";
+
+  std::vector<Node> nodes;
+  nodes.push_back(make_node("bool", BuiltinType{"bool"}));
+  nodes.push_back(make_node("unsigned int", BuiltinType{"unsigned int"}));
+  nodes.push_back(make_node("Node *", PointerType{"Node"}));
+  nodes.push_back(make_node("Color", std::move(color)));
+  nodes.push_back(make_node("Node", std::move(record)));
+  std::string header = header_for(std::move(nodes));
+
+  TYPEDB_CHECK(contains(header, "struct alignas(8) Node {"));
+  TYPEDB_CHECK(contains(header, "static constexpr std::size_t size = 24;"));
+  TYPEDB_CHECK(contains(header, "bool flag;\n  std::byte pad[7];\n"
+                                "  void *next;\n"));
+  TYPEDB_CHECK(contains(header, "offset_of_bits = 16;"));
+  TYPEDB_CHECK(contains(header, "bit_offset_of_bits = 3;"));
+  TYPEDB_CHECK(contains(header, "bit_width_of_bits = 5;"));
+  TYPEDB_CHECK(contains(header, "std::byte pad_2[4];\n  std::uint32_t color;"));
+  TYPEDB_CHECK(contains(header, "static_assert(sizeof(Node) == Node::size);"));
+  TYPEDB_CHECK(contains(header, "static_assert(offsetof(Node, color) == "
+                                "Node::offset_of_color);"));
+  TYPEDB_CHECK(contains(header, "sizeof(void *) == 8"));
+}
+
+void test_vftable() {
+  VfTableType table;
+  table.original_record = "Base";
+  ObjectField dtor;
+  dtor.name = "~Base";
+  ObjectField update;
+  update.name = "update";
+  table.fields = {dtor, update};
+  std::vector<Node> nodes;
+  nodes.push_back(make_node("Base::vftable", std::move(table)));
+  std::string header = header_for(std::move(nodes));
+  TYPEDB_CHECK(contains(header, "struct Base_vftable {"));
+  TYPEDB_CHECK(contains(header, "dtor = 0,\n    update = 1,"));
+  TYPEDB_CHECK(contains(header, "slot_count = 2;"));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_builtin_members();
+  test_cv_qualified_builtins();
+  test_record_layout();
+  test_vftable();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,144 @@
+#include "typedb.h"
+#include "typedb_json.h"
+#include "typedb_test.h"
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto make_enum(std::vector<Enumerator> enumerators, bool is_signed,
+               std::string underlying_type = "int") -> EnumType {
+  EnumType type;
+  type.size_bytes = 8;
+  type.align_bytes = 8;
+  type.underlying_type = std::move(underlying_type);
+  type.is_signed = is_signed;
+  type.enumerators = std::move(enumerators);
+  type.build_value_order();
+  return type;
+}
+
+auto as_bits(int64_t value) -> uint64_t { return static_cast<uint64_t>(value); }
+
+auto order_of(const EnumType &type) -> std::string {
+  std::string names;
+  for (uint32_t index : type.value_order) {
+    names += type.enumerators[index].name + " ";
+  }
+  return names;
+}
+
+auto found_name(const EnumType &type, uint64_t value) -> std::string {
+  const Enumerator *found = type.find_value(value);
+  return found != nullptr ? found->name : "<none>";
+}
+
+// Writes `type` as the only node of a database and reads it back.
+auto round_trip(const EnumType &type, bool legacy) -> EnumType {
+  TypeDb db;
+  Node node;
+  node.name = "E";
+  node.data = type;
+  db.nodes.push_back(std::move(node));
+  db.build_indices();
+  std::string text =
+      llvm::formatv("{0:2}", typedb_to_json(db, {.legacy_schema = legacy}))
+          .str();
+  llvm::Expected<TypeDb> parsed = typedb_from_json(text);
+  if (!parsed) {
+    TYPEDB_CHECK_EQ(llvm::toString(parsed.takeError()), std::string());
+    return {};
+  }
+  return std::get<EnumType>(parsed->nodes.at(0).data);
+}
+
+void test_value_order() {
+  EnumType type = make_enum(
+      {{"B", 2}, {"A", 1}, {"AlsoB", 2}, {"Neg", as_bits(-1)}}, true);
+  TYPEDB_CHECK_EQ(order_of(type), std::string("Neg A B AlsoB "));
+  TYPEDB_CHECK_EQ(found_name(type, 2), std::string("B"));
+  TYPEDB_CHECK_EQ(found_name(type, as_bits(-1)), std::string("Neg"));
+  TYPEDB_CHECK_EQ(found_name(type, 3), std::string("<none>"));
+
+  // The same bits order last when the enum is unsigned.
+  type.is_signed = false;
+  type.build_value_order();
+  TYPEDB_CHECK_EQ(order_of(type), std::string("A B AlsoB Neg "));
+  TYPEDB_CHECK_EQ(found_name(type, as_bits(-1)), std::string("Neg"));
+
+  EnumType empty = make_enum({}, false);
+  TYPEDB_CHECK(empty.find_value(0) == nullptr);
+  TYPEDB_CHECK(!empty.is_flags);
+}
+
+void test_flags() {
+  auto is_flags = [](std::vector<Enumerator> enumerators, bool is_signed) {
+    return make_enum(std::move(enumerators), is_signed).is_flags;
+  };
+  TYPEDB_CHECK(is_flags({{"A", 1}, {"B", 2}, {"C", 4}, {"D", 8}}, false));
+  TYPEDB_CHECK(is_flags({{"None", 0}, {"A", 1}, {"B", 4}, {"AB", 5}}, false));
+  // Contiguous ranges are plain enumerations even when they are 0, 1, 2.
+  TYPEDB_CHECK(!is_flags({{"A", 0}, {"B", 1}, {"C", 2}, {"D", 3}}, false));
+  TYPEDB_CHECK(!is_flags({{"A", 1}, {"B", 2}}, false));
+  // 5 is not made of the single-bit enumerators 1 and 2.
+  TYPEDB_CHECK(!is_flags({{"A", 1}, {"B", 2}, {"C", 5}}, false));
+  TYPEDB_CHECK(!is_flags({{"A", 4}}, false));
+  TYPEDB_CHECK(!is_flags({{"Neg", as_bits(-1)}, {"A", 1}, {"B", 4}}, true));
+  TYPEDB_CHECK(is_flags({{"A", 1}, {"B", 4}, {"High", 1ULL << 63}}, false));
+}
+
+void test_unsigned_round_trip() {
+  EnumType type = make_enum({{"Max", UINT64_MAX},
+                             {"Zero", 0},
+                             {"High", 0x8000000000000000ULL}},
+                            false, "unsigned long long");
+  for (bool legacy : {false, true}) {
+    EnumType parsed = round_trip(type, legacy);
+    TYPEDB_CHECK(!parsed.is_signed);
+    TYPEDB_CHECK_EQ(parsed.enumerators.size(), size_t{3});
+    TYPEDB_CHECK_EQ(parsed.enumerators.at(0).value, UINT64_MAX);
+    TYPEDB_CHECK_EQ(order_of(parsed), std::string("Zero High Max "));
+    TYPEDB_CHECK_EQ(found_name(parsed, UINT64_MAX), std::string("Max"));
+    TYPEDB_CHECK_EQ(found_name(parsed, 0x8000000000000000ULL),
+                    std::string("High"));
+    TYPEDB_CHECK_EQ(found_name(parsed, 0), std::string("Zero"));
+  }
+}
+
+void test_signed_round_trip() {
+  EnumType type = make_enum({{"Zero", 0},
+                             {"Min", as_bits(INT64_MIN)},
+                             {"Neg", as_bits(-1)},
+                             {"Max", as_bits(INT64_MAX)}},
+                            true, "long long");
+  for (bool legacy : {false, true}) {
+    EnumType parsed = round_trip(type, legacy);
+    TYPEDB_CHECK(parsed.is_signed);
+    TYPEDB_CHECK_EQ(order_of(parsed), std::string("Min Neg Zero Max "));
+    TYPEDB_CHECK_EQ(found_name(parsed, as_bits(INT64_MIN)),
+                    std::string("Min"));
+    TYPEDB_CHECK_EQ(found_name(parsed, as_bits(-1)), std::string("Neg"));
+  }
+
+  // Signed enums without negative values only say so through "is_signed".
+  EnumType positive = make_enum({{"A", 1}, {"B", 2}, {"C", 4}}, true);
+  EnumType parsed = round_trip(positive, false);
+  TYPEDB_CHECK(parsed.is_signed);
+  TYPEDB_CHECK(parsed.is_flags);
+}
+
+} // namespace
+
+auto main() -> int {
+  test_value_order();
+  test_flags();
+  test_unsigned_round_trip();
+  test_signed_round_trip();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,88 @@
+#include "typedb_interner.h"
+#include <cstring>
+#include <llvm/Support/ErrorHandling.h>
+#include <mutex>
+
+namespace me3::typedb {
+
+auto TypeIdInterner::shard_of(llvm::StringRef id) -> unsigned {
+  return static_cast<unsigned>(
+             llvm::DenseMapInfo<llvm::StringRef>::getHashValue(id)) &
+         (kShardCount - 1);
+}
+
+auto TypeIdInterner::intern(llvm::StringRef id) -> TypeIdHandle {
+  return intern_entry(id).first;
+}
+
+auto TypeIdInterner::canonical(llvm::StringRef id) -> llvm::StringRef {
+  return intern_entry(id).second;
+}
+
+auto TypeIdInterner::intern_entry(llvm::StringRef id)
+    -> std::pair<TypeIdHandle, llvm::StringRef> {
+  const unsigned shard_index = shard_of(id);
+  Shard &shard = shards_[shard_index];
+  {
+    std::shared_lock lock(shard.mutex);
+    auto found = shard.handles.find(id);
+    if (found != shard.handles.end()) {
+      return {found->second, found->first};
+    }
+  }
+  std::unique_lock lock(shard.mutex);
+  auto found = shard.handles.find(id);
+  if (found != shard.handles.end()) {
+    return {found->second, found->first};
+  }
+  if (shard.strings.size() >= kMaxShardStrings) {
+    llvm::report_fatal_error("type id interner: too many ids for 32-bit "
+                             "handles");
+  }
+  char *storage = shard.arena.Allocate<char>(id.size() + 1);
+  std::memcpy(storage, id.data(), id.size());
+  storage[id.size()] = '\0';
+  llvm::StringRef stored(storage, id.size());
+  auto handle = static_cast<TypeIdHandle>((shard.strings.size() << kShardBits) |
+                                          shard_index);
+  shard.strings.push_back(stored);
+  shard.handles.try_emplace(stored, handle);
+  return {handle, stored};
+}
+
+auto TypeIdInterner::find(llvm::StringRef id) const
+    -> std::optional<TypeIdHandle> {
+  const Shard &shard = shards_[shard_of(id)];
+  std::shared_lock lock(shard.mutex);
+  auto found = shard.handles.find(id);
+  if (found == shard.handles.end()) {
+    return std::nullopt;
+  }
+  return found->second;
+}
+
+auto TypeIdInterner::lookup(TypeIdHandle handle) const -> llvm::StringRef {
+  const Shard &shard = shards_[handle & (kShardCount - 1)];
+  std::shared_lock lock(shard.mutex);
+  return shard.strings[handle >> kShardBits];
+}
+
+auto TypeIdInterner::size() const -> size_t {
+  size_t total = 0;
+  for (const Shard &shard : shards_) {
+    std::shared_lock lock(shard.mutex);
+    total += shard.strings.size();
+  }
+  return total;
+}
+
+auto TypeIdInterner::arena_bytes() const -> size_t {
+  size_t total = 0;
+  for (const Shard &shard : shards_) {
+    std::shared_lock lock(shard.mutex);
+    total += shard.arena.getBytesAllocated();
+  }
+  return total;
+}
+
+} // namespace me3::typedb
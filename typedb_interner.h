@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Allocator.h>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace me3::typedb {
+
+// Stable integer handle for an interned type id string.
+using TypeIdHandle = uint32_t;
+
+// String interner shared by the builder threads of one run. Strings live in
+// per-shard arenas for the lifetime of the interner, so the workers' dedup
+// sets all refer to one canonical copy of e.g. "std::basic_string<char> *".
+// Node payloads still own their strings, since a TypeDb outlives the build.
+// Shards are picked by hash and guarded by reader/writer locks: lookups of
+// known ids take the shard's lock in shared mode, so they still touch the
+// lock word but do not wait for each other. Builders cache canonical() views
+// per translation unit, so ids a unit has already seen do not reach the
+// interner at all.
+class TypeIdInterner {
+public:
+  TypeIdInterner() = default;
+  TypeIdInterner(const TypeIdInterner &) = delete;
+  auto operator=(const TypeIdInterner &) -> TypeIdInterner & = delete;
+
+  auto intern(llvm::StringRef id) -> TypeIdHandle;
+  // Interns `id` and returns the interner's copy of it, which stays valid for
+  // the lifetime of the interner.
+  auto canonical(llvm::StringRef id) -> llvm::StringRef;
+  [[nodiscard]] auto find(llvm::StringRef id) const
+      -> std::optional<TypeIdHandle>;
+  // The returned view stays valid for the lifetime of the interner.
+  [[nodiscard]] auto lookup(TypeIdHandle handle) const -> llvm::StringRef;
+
+  [[nodiscard]] auto size() const -> size_t;
+  [[nodiscard]] auto arena_bytes() const -> size_t;
+
+private:
+  static constexpr unsigned kShardBits = 6;
+  static constexpr unsigned kShardCount = 1U << kShardBits;
+  // A handle is a shard-local index above the shard bits.
+  static constexpr size_t kMaxShardStrings = size_t{1} << (32 - kShardBits);
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    llvm::DenseMap<llvm::StringRef, TypeIdHandle> handles;
+    std::vector<llvm::StringRef> strings;
+    llvm::BumpPtrAllocator arena;
+  };
+
+  static auto shard_of(llvm::StringRef id) -> unsigned;
+  auto intern_entry(llvm::StringRef id)
+      -> std::pair<TypeIdHandle, llvm::StringRef>;
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+} // namespace me3::typedb
@@ -0,0 +1,75 @@
+#include "typedb_interner.h"
+#include "typedb_test.h"
+#include <llvm/ADT/StringRef.h>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using me3::typedb::TypeIdHandle;
+using me3::typedb::TypeIdInterner;
+
+namespace {
+
+void test_intern_and_lookup() {
+  TypeIdInterner interner;
+  TYPEDB_CHECK_EQ(interner.size(), size_t{0});
+  TYPEDB_CHECK(!interner.find("int").has_value());
+
+  std::string id = "std::basic_string<char> *";
+  TypeIdHandle handle = interner.intern(id);
+  TYPEDB_CHECK_EQ(interner.intern(id), handle);
+  TYPEDB_CHECK(interner.intern("int") != handle);
+  TYPEDB_CHECK(interner.find(id) == std::optional<TypeIdHandle>(handle));
+  TYPEDB_CHECK_EQ(interner.lookup(handle), llvm::StringRef(id));
+  TYPEDB_CHECK_EQ(interner.size(), size_t{2});
+  TYPEDB_CHECK(interner.arena_bytes() > 0);
+
+  // canonical() hands out the interner's copy, not the caller's.
+  llvm::StringRef stored = interner.canonical(id);
+  TYPEDB_CHECK_EQ(stored, llvm::StringRef(id));
+  TYPEDB_CHECK(stored.data() != id.data());
+  TYPEDB_CHECK(stored.data() == interner.lookup(handle).data());
+  id.assign(id.size(), 'x');
+  TYPEDB_CHECK_EQ(stored, llvm::StringRef("std::basic_string<char> *"));
+  TYPEDB_CHECK_EQ(interner.size(), size_t{2});
+}
+
+void test_concurrent_intern() {
+  constexpr unsigned kThreads = 4;
+  constexpr size_t kIds = 2000;
+  TypeIdInterner interner;
+  std::vector<std::vector<TypeIdHandle>> handles(
+      kThreads, std::vector<TypeIdHandle>(kIds));
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Threads walk the ids forwards from different offsets or backwards.
+      for (size_t i = 0; i < kIds; ++i) {
+        size_t id = t % 2 == 0 ? (i + t * kIds / kThreads) % kIds
+                               : kIds - 1 - i;
+        handles[t][id] = interner.intern("type_" + std::to_string(id));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  TYPEDB_CHECK_EQ(interner.size(), kIds);
+  for (size_t id = 0; id < kIds; ++id) {
+    for (unsigned t = 1; t < kThreads; ++t) {
+      TYPEDB_CHECK_EQ(handles[t][id], handles[0][id]);
+    }
+    TYPEDB_CHECK_EQ(interner.lookup(handles[0][id]),
+                    llvm::StringRef("type_" + std::to_string(id)));
+  }
+}
+
+} // namespace
+
+auto main() -> int {
+  test_intern_and_lookup();
+  test_concurrent_intern();
+  return me3::typedb::test::test_result();
+}
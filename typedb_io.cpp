@@ -0,0 +1,213 @@
+#include "typedb_io.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/Errc.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/FileSystem.h>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef ME3_TYPEDB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace me3::typedb {
+namespace {
+
+constexpr std::array<unsigned char, 4> kZstdMagic = {0x28, 0xB5, 0x2F, 0xFD};
+
+auto has_zstd_magic(llvm::StringRef data) -> bool {
+  return data.size() >= kZstdMagic.size() &&
+         std::memcmp(data.data(), kZstdMagic.data(), kZstdMagic.size()) == 0;
+}
+
+#ifdef ME3_TYPEDB_HAVE_ZSTD
+class ZstdOutputStream : public llvm::raw_ostream {
+public:
+  static auto create(std::unique_ptr<llvm::raw_ostream> sink,
+                     const OutputOptions &options)
+      -> llvm::Expected<std::unique_ptr<llvm::raw_ostream>> {
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if (cctx == nullptr) {
+      return llvm::createStringError(
+          llvm::errc::not_enough_memory,
+          "zstd: cannot allocate a compression context");
+    }
+    return std::unique_ptr<llvm::raw_ostream>(
+        new ZstdOutputStream(std::move(sink), cctx, options));
+  }
+
+  ZstdOutputStream(const ZstdOutputStream &) = delete;
+  auto operator=(const ZstdOutputStream &) -> ZstdOutputStream & = delete;
+
+  ~ZstdOutputStream() override {
+    flush();
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    size_t remaining = 0;
+    do {
+      remaining = drive(input, ZSTD_e_end);
+    } while (remaining != 0 && !ZSTD_isError(remaining));
+    sink_->flush();
+    ZSTD_freeCCtx(cctx_);
+  }
+
+private:
+  // Takes ownership of `cctx`.
+  ZstdOutputStream(std::unique_ptr<llvm::raw_ostream> sink, ZSTD_CCtx *cctx,
+                   const OutputOptions &options)
+      : sink_(std::move(sink)), cctx_(cctx),
+        out_buffer_(ZSTD_CStreamOutSize()) {
+    ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, options.level);
+    ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
+    unsigned threads = options.threads != 0
+                           ? options.threads
+                           : std::max(1U, std::thread::hardware_concurrency());
+    // Fails on a libzstd built without ZSTD_MULTITHREAD; compression then
+    // simply stays on the calling thread.
+    ZSTD_CCtx_setParameter(cctx_, ZSTD_c_nbWorkers, static_cast<int>(threads));
+    SetBufferSize(ZSTD_CStreamInSize());
+  }
+
+  void write_impl(const char *ptr, size_t size) override {
+    ZSTD_inBuffer input{ptr, size, 0};
+    while (input.pos < input.size) {
+      drive(input, ZSTD_e_continue);
+    }
+    written_ += size;
+  }
+
+  [[nodiscard]] auto current_pos() const -> uint64_t override {
+    return written_;
+  }
+
+  auto drive(ZSTD_inBuffer &input, ZSTD_EndDirective mode) -> size_t {
+    ZSTD_outBuffer output{out_buffer_.data(), out_buffer_.size(), 0};
+    size_t result = ZSTD_compressStream2(cctx_, &output, &input, mode);
+    if (ZSTD_isError(result)) {
+      llvm::report_fatal_error(llvm::Twine("zstd: ") +
+                               ZSTD_getErrorName(result));
+    }
+    sink_->write(out_buffer_.data(), output.pos);
+    return result;
+  }
+
+  std::unique_ptr<llvm::raw_ostream> sink_;
+  ZSTD_CCtx *cctx_;
+  std::vector<char> out_buffer_;
+  uint64_t written_ = 0;
+};
+
+// Owns a decompressed document, so it can be handed out like a file buffer.
+class StringMemoryBuffer : public llvm::MemoryBuffer {
+public:
+  explicit StringMemoryBuffer(std::string data) : data_(std::move(data)) {
+    init(data_.data(), data_.data() + data_.size(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  auto getBufferKind() const -> BufferKind override {
+    return MemoryBuffer_Malloc;
+  }
+
+private:
+  std::string data_;
+};
+
+auto decompress_zstd(llvm::StringRef data) -> llvm::Expected<std::string> {
+  ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  if (dctx == nullptr) {
+    return llvm::createStringError(
+        llvm::errc::not_enough_memory,
+        "zstd: cannot allocate a decompression context");
+  }
+  std::string result;
+  unsigned long long content_size =
+      ZSTD_getFrameContentSize(data.data(), data.size());
+  if (content_size != ZSTD_CONTENTSIZE_UNKNOWN &&
+      content_size != ZSTD_CONTENTSIZE_ERROR) {
+    result.reserve(content_size);
+  }
+  std::vector<char> out_buffer(ZSTD_DStreamOutSize());
+  ZSTD_inBuffer input{data.data(), data.size(), 0};
+  size_t last = 0;
+  while (input.pos < input.size) {
+    ZSTD_outBuffer output{out_buffer.data(), out_buffer.size(), 0};
+    last = ZSTD_decompressStream(dctx, &output, &input);
+    if (ZSTD_isError(last)) {
+      std::string message = ZSTD_getErrorName(last);
+      ZSTD_freeDCtx(dctx);
+      return llvm::createStringError(llvm::errc::illegal_byte_sequence,
+                                     "zstd: %s", message.c_str());
+    }
+    result.append(out_buffer.data(), output.pos);
+  }
+  ZSTD_freeDCtx(dctx);
+  if (last != 0) {
+    return llvm::createStringError(llvm::errc::illegal_byte_sequence,
+                                   "zstd: truncated frame");
+  }
+  return result;
+}
+#endif
+
+} // namespace
+
+auto zstd_available() -> bool {
+#ifdef ME3_TYPEDB_HAVE_ZSTD
+  return true;
+#else
+  return false;
+#endif
+}
+
+auto open_output(llvm::StringRef path, const OutputOptions &options)
+    -> llvm::Expected<std::unique_ptr<llvm::raw_ostream>> {
+  std::error_code error;
+  auto file = std::make_unique<llvm::raw_fd_ostream>(path, error,
+                                                     llvm::sys::fs::OF_None);
+  if (error) {
+    return llvm::createFileError(path, error);
+  }
+  switch (options.compression) {
+  case Compression::None:
+    return std::unique_ptr<llvm::raw_ostream>(std::move(file));
+  case Compression::Zstd:
+#ifdef ME3_TYPEDB_HAVE_ZSTD
+    return ZstdOutputStream::create(std::move(file), options);
+#else
+    return llvm::createStringError(llvm::errc::not_supported,
+                                   "built without zstd support");
+#endif
+  }
+  return llvm::createStringError(llvm::errc::invalid_argument,
+                                 "unknown compression");
+}
+
+auto read_input(llvm::StringRef path)
+    -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFileOrSTDIN(path, /*IsText=*/false,
+                                         /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    return llvm::createFileError(path, buffer.getError());
+  }
+  if (!has_zstd_magic((*buffer)->getBuffer())) {
+    return std::move(*buffer);
+  }
+#ifdef ME3_TYPEDB_HAVE_ZSTD
+  llvm::Expected<std::string> text = decompress_zstd((*buffer)->getBuffer());
+  if (!text) {
+    return text.takeError();
+  }
+  return std::make_unique<StringMemoryBuffer>(std::move(*text));
+#else
+  return llvm::createFileError(
+      path, llvm::createStringError(llvm::errc::not_supported,
+                                    "zstd input but built without zstd"));
+#endif
+}
+
+} // namespace me3::typedb
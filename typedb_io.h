@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <string>
+
+namespace me3::typedb {
+
+enum class Compression : uint8_t {
+  None,
+  Zstd,
+};
+
+struct OutputOptions {
+  Compression compression = Compression::None;
+  int level = 3;
+  // Compression worker threads; 0 selects the hardware concurrency.
+  unsigned threads = 0;
+};
+
+// True when this build can read and write zstd streams.
+auto zstd_available() -> bool;
+
+// Opens `path` ("-" for stdout) for writing. With zstd compression the
+// returned stream compresses blocks as they are written and finishes the
+// frame when destroyed.
+auto open_output(llvm::StringRef path, const OutputOptions &options)
+    -> llvm::Expected<std::unique_ptr<llvm::raw_ostream>>;
+
+// Reads `path` ("-" for stdin) into memory, transparently decompressing it
+// when it starts with a zstd frame. Uncompressed files are returned as read
+// (usually mapped), without a copy.
+auto read_input(llvm::StringRef path)
+    -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>;
+
+} // namespace me3::typedb
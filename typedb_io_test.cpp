@@ -0,0 +1,119 @@
+#include "typedb_io.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <string>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto temp_path(llvm::StringRef suffix) -> std::string {
+  llvm::SmallString<256> path;
+  if (llvm::sys::fs::createTemporaryFile("typedb_io_test", suffix, path)) {
+    return {};
+  }
+  return std::string(path);
+}
+
+auto sample_text() -> std::string {
+  std::string text;
+  for (int i = 0; i < 20000; ++i) {
+    text += "{\"kind\":\"pointer\",\"pointee\":\"int\"}," + std::to_string(i);
+  }
+  return text;
+}
+
+auto write_file(const std::string &path, const std::string &text,
+                const OutputOptions &options) -> bool {
+  llvm::Expected<std::unique_ptr<llvm::raw_ostream>> out =
+      open_output(path, options);
+  if (!out) {
+    llvm::consumeError(out.takeError());
+    return false;
+  }
+  **out << text;
+  return true;
+}
+
+// Raw bytes, without read_input's decompression.
+auto read_file(const std::string &path) -> llvm::Expected<std::string> {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    return llvm::createFileError(path, buffer.getError());
+  }
+  return (*buffer)->getBuffer().str();
+}
+
+void test_plain_round_trip() {
+  std::string path = temp_path("json");
+  std::string text = sample_text();
+  TYPEDB_CHECK(write_file(path, text, {}));
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> read =
+      read_input(path);
+  TYPEDB_CHECK(static_cast<bool>(read));
+  if (read) {
+    TYPEDB_CHECK((*read)->getBuffer() == text);
+  } else {
+    llvm::consumeError(read.takeError());
+  }
+  llvm::sys::fs::remove(path);
+}
+
+void test_zstd_round_trip() {
+  OutputOptions options;
+  options.compression = Compression::Zstd;
+  options.threads = 2;
+  std::string path = temp_path("json.zst");
+  std::string text = sample_text();
+  if (!zstd_available()) {
+    llvm::Expected<std::unique_ptr<llvm::raw_ostream>> out =
+        open_output(path, options);
+    TYPEDB_CHECK(!out);
+    if (!out) {
+      llvm::consumeError(out.takeError());
+    }
+    llvm::sys::fs::remove(path);
+    return;
+  }
+  TYPEDB_CHECK(write_file(path, text, options));
+  uint64_t size = 0;
+  TYPEDB_CHECK(!llvm::sys::fs::file_size(path, size));
+  TYPEDB_CHECK(size < text.size() / 4);
+
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> read =
+      read_input(path);
+  TYPEDB_CHECK(static_cast<bool>(read));
+  if (read) {
+    TYPEDB_CHECK((*read)->getBuffer() == text);
+  } else {
+    llvm::consumeError(read.takeError());
+  }
+
+  // A frame cut short is an error, not a silently short document.
+  llvm::Expected<std::string> compressed = read_file(path);
+  TYPEDB_CHECK(static_cast<bool>(compressed));
+  if (!compressed) {
+    llvm::consumeError(compressed.takeError());
+    return;
+  }
+  TYPEDB_CHECK(write_file(path, compressed->substr(0, size / 2), {}));
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> truncated =
+      read_input(path);
+  TYPEDB_CHECK(!truncated);
+  if (!truncated) {
+    llvm::consumeError(truncated.takeError());
+  }
+  llvm::sys::fs::remove(path);
+}
+
+} // namespace
+
+auto main() -> int {
+  test_plain_round_trip();
+  test_zstd_round_trip();
+  return me3::typedb::test::test_result();
+}
@@ -1,8 +1,14 @@
 #include "typedb_json.h"
+#include <type_traits>
 
 namespace me3::typedb {
 
-static auto field_json(const ObjectField &field) -> llvm::json::Object {
+namespace {
+constexpr uint64_t kBitsPerByte = 8;
+} // namespace
+
+static auto field_json(const ObjectField &field, bool legacy_schema)
+    -> llvm::json::Object {
   llvm::json::Object field_obj;
   if (field.is_base) {
     field_obj["kind"] = "base";
@@ -23,12 +29,21 @@ static auto field_json(const ObjectField &field) -> llvm::json::Object {
   if (field.layout_known && field.size_bytes != 0) {
     field_obj["size_bytes"] = field.size_bytes;
   }
+  // Offsets postdate the legacy schema.
+  if (field.offset_bits && !legacy_schema) {
+    field_obj["offset_bytes"] = *field.offset_bits / kBitsPerByte;
+    if (field.is_bitfield) {
+      field_obj["bit_offset"] = *field.offset_bits % kBitsPerByte;
+    }
+  }
   field_obj["type"] = field.type_id;
   return field_obj;
 }
 
 namespace {
 struct NodeJsonVisitor {
+  bool legacy_schema = false;
+
   static auto to_array(const std::vector<std::string> &values)
       -> llvm::json::Array {
     llvm::json::Array json_array;
@@ -123,7 +138,7 @@ struct NodeJsonVisitor {
     llvm::json::Array field_array;
     field_array.reserve(value.fields.size());
     for (auto const &field : value.fields) {
-      field_array.push_back(field_json(field));
+      field_array.push_back(field_json(field, legacy_schema));
     }
     object["fields"] = std::move(field_array);
     return object;
@@ -134,19 +149,47 @@ struct NodeJsonVisitor {
     result["size_bytes"] = value.size_bytes;
     result["align_bytes"] = value.align_bytes;
     result["underlying_type"] = value.underlying_type;
+    if (!legacy_schema && value.is_signed) {
+      result["is_signed"] = true;
+    }
+    if (!legacy_schema && value.is_flags) {
+      result["is_flags"] = true;
+    }
     if (!value.enumerators.empty()) {
       llvm::json::Array enumerator_array;
       enumerator_array.reserve(value.enumerators.size());
       for (auto const &enumerator : value.enumerators) {
         llvm::json::Object enumerator_object;
-        enumerator_object["name"] = enumerator.first;
-        enumerator_object["value"] = enumerator.second;
+        enumerator_object["name"] = enumerator.name;
+        enumerator_object["value"] = enumerator_value(value, enumerator);
         enumerator_array.push_back(std::move(enumerator_object));
       }
       result["enumerators"] = std::move(enumerator_array);
+      if (!legacy_schema) {
+        llvm::json::Array by_value;
+        by_value.reserve(value.value_order.size());
+        for (uint32_t index : value.value_order) {
+          by_value.push_back(index);
+        }
+        result["by_value"] = std::move(by_value);
+      }
     }
     return result;
   }
+  // Schemas before 7 spelled enumerator values as decimal strings.
+  auto enumerator_value(const EnumType &type,
+                        const Enumerator &enumerator) const
+      -> llvm::json::Value {
+    if (legacy_schema) {
+      return type.is_signed
+                 ? std::to_string(static_cast<int64_t>(enumerator.value))
+                 : std::to_string(enumerator.value);
+    }
+    if (type.is_signed) {
+      return static_cast<int64_t>(enumerator.value);
+    }
+    return enumerator.value;
+  }
   auto operator()(const VfTableType &value) const -> llvm::json::Object {
     llvm::json::Object result;
     result["kind"] = "vftable";
@@ -175,30 +218,108 @@ struct NodeJsonVisitor {
     return result;
   }
 };
+
+// Schema 5 emitted a cdecl for every interned node, i.e. everything except
+// records, enums and synthetic vftables.
+template <typename Kind> constexpr auto had_legacy_cdecl() -> bool {
+  return !std::is_same_v<Kind, ObjectType> && !std::is_same_v<Kind, EnumType> &&
+         !std::is_same_v<Kind, VfTableType>;
+}
 } // namespace
 
-static auto node_payload(const Node &node) -> llvm::json::Object {
-  llvm::json::Object payload = std::visit(NodeJsonVisitor{}, node.data);
+template <typename Kind>
+auto node_json(const std::string &name, const std::string &cdecl,
+               const Kind &data, const JsonOptions &options)
+    -> llvm::json::Object {
+  llvm::json::Object payload =
+      NodeJsonVisitor{.legacy_schema = options.legacy_schema}(data);
+  if (!cdecl.empty()) {
+    payload["cdecl"] = cdecl;
+  } else if (options.legacy_schema && had_legacy_cdecl<Kind>()) {
+    payload["cdecl"] = name;
+  }
   return payload;
 }
 
-auto typedb_to_json(const TypeDb &type_db) -> llvm::json::Value {
+#define ME3_TYPEDB_INSTANTIATE_NODE_JSON(Kind)                                 \
+  template auto node_json<Kind>(const std::string &, const std::string &,      \
+                                const Kind &, const JsonOptions &)             \
+      -> llvm::json::Object;
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(BuiltinType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(TemplateParameterType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(PointerType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(FixedSizeArrayType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(UnsizedArrayType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(FunctionType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(TemplateSpecializationType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(ObjectType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(EnumType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(VfTableType)
+ME3_TYPEDB_INSTANTIATE_NODE_JSON(UnknownType)
+#undef ME3_TYPEDB_INSTANTIATE_NODE_JSON
+static_assert(std::variant_size_v<NodeVariant> == 11,
+              "instantiate node_json for every NodeVariant alternative");
+
+auto node_to_json(const Node &node, const JsonOptions &options)
+    -> llvm::json::Object {
+  return std::visit(
+      [&](const auto &data) {
+        return node_json(node.name, node.cdecl, data, options);
+      },
+      node.data);
+}
+
+auto typedb_to_json(const TypeDb &type_db, const JsonOptions &options)
+    -> llvm::json::Value {
   llvm::json::Object root;
-  root["schema_version"] = SCHEMA_VERSION;
+  root["schema_version"] =
+      options.legacy_schema ? LEGACY_SCHEMA_VERSION : SCHEMA_VERSION;
   root["triple"] = type_db.triple;
   root["pointer_width_bits"] = type_db.pointer_width_bits;
   root["char_width_bits"] = type_db.char_width_bits;
   root["long_width_bits"] = type_db.long_width_bits;
   llvm::json::Object nodes_obj;
-  for (auto const &node : type_db.nodes) {
-    llvm::json::Object payload = node_payload(node);
-    if (!node.cdecl.empty()) {
-      payload["cdecl"] = node.cdecl;
-    }
-    nodes_obj[node.name] = std::move(payload);
-  }
+  type_db.for_each_node([&](const std::string &name, const std::string &cdecl,
+                            const auto &data) {
+    nodes_obj[name] = node_json(name, cdecl, data, options);
+  });
   root["nodes"] = std::move(nodes_obj);
-  return { std::move(root) };
+  // Not `return {std::move(root)};`, which would build a one-element array.
+  return llvm::json::Value(std::move(root));
+}
+
+TypeDbJsonWriter::TypeDbJsonWriter(llvm::raw_ostream &out, JsonOptions options,
+                                   unsigned indent)
+    : out_(&out), options_(options), indent_(indent) {}
+
+void TypeDbJsonWriter::begin(const TypeDb &header) {
+  // Keys go out in the sorted order llvm::json prints typedb_to_json's root
+  // object in, so the two agree byte for byte apart from node order.
+  triple_ = header.triple;
+  pointer_width_bits_ = header.pointer_width_bits;
+  stream_.emplace(*out_, indent_);
+  stream_->objectBegin();
+  stream_->attribute("char_width_bits", header.char_width_bits);
+  stream_->attribute("long_width_bits", header.long_width_bits);
+  stream_->attributeBegin("nodes");
+  stream_->objectBegin();
+}
+
+void TypeDbJsonWriter::node(Node &&node) {
+  stream_->attribute(node.name, node_to_json(node, options_));
+}
+
+void TypeDbJsonWriter::end() {
+  stream_->objectEnd();
+  stream_->attributeEnd();
+  stream_->attribute("pointer_width_bits", pointer_width_bits_);
+  stream_->attribute("schema_version", options_.legacy_schema
+                                           ? LEGACY_SCHEMA_VERSION
+                                           : SCHEMA_VERSION);
+  stream_->attribute("triple", triple_);
+  stream_->objectEnd();
+  stream_.reset();
+  *out_ << "\n";
 }
 
 } // namespace me3::typedb
@@ -1,9 +1,64 @@
 #pragma once
 #include "typedb.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
 #include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <string>
 
 namespace me3::typedb {
 
-auto typedb_to_json(const TypeDb &type_db) -> llvm::json::Value;
+struct JsonOptions {
+  // Emit LEGACY_SCHEMA_VERSION output, spelling out cdecl even when it is
+  // identical to the node name.
+  bool legacy_schema = false;
+};
 
-}
\ No newline at end of file
+// Payload of a single node as it appears under "nodes".
+auto node_to_json(const Node &node, const JsonOptions &options = {})
+    -> llvm::json::Object;
+
+// node_to_json for a node visited through TypeDb::for_each_node, which may
+// live in a column rather than a Node. Instantiated for every NodeVariant
+// alternative.
+template <typename Kind>
+auto node_json(const std::string &name, const std::string &cdecl,
+               const Kind &data, const JsonOptions &options = {})
+    -> llvm::json::Object;
+
+auto typedb_to_json(const TypeDb &type_db, const JsonOptions &options = {})
+    -> llvm::json::Value;
+
+// Parses typedb_to_json output (schema 5.x to 7.x) directly into a TypeDb,
+// without building an intermediate llvm::json DOM.
+auto typedb_from_json(llvm::StringRef json) -> llvm::Expected<TypeDb>;
+
+// Reads, decompresses if needed, and parses a database file ("-" for stdin).
+auto load_typedb_file(llvm::StringRef path) -> llvm::Expected<TypeDb>;
+
+// Streams each translation unit's TypeDb to `out` node by node, for use as
+// BuildOptions::sink. Each unit is written as typedb_to_json formatted with
+// an indent of `indent` and a trailing newline, except that nodes appear in
+// the order they are built rather than sorted by name. Not thread-safe: one
+// build at a time.
+class TypeDbJsonWriter : public NodeSink {
+public:
+  explicit TypeDbJsonWriter(llvm::raw_ostream &out, JsonOptions options = {},
+                            unsigned indent = 2);
+
+  void begin(const TypeDb &header) override;
+  void node(Node &&node) override;
+  void end() override;
+
+private:
+  llvm::raw_ostream *out_;
+  JsonOptions options_;
+  unsigned indent_;
+  std::optional<llvm::json::OStream> stream_;
+  // Header fields that sort after "nodes".
+  std::string triple_;
+  int pointer_width_bits_ = 0;
+};
+
+} // namespace me3::typedb
@@ -0,0 +1,865 @@
+#include "typedb.h"
+#include "typedb_io.h"
+#include "typedb_json.h"
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Errc.h>
+#include <llvm/Support/Error.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ME3_TYPEDB_SSE2 1
+#endif
+
+namespace me3::typedb {
+namespace {
+
+constexpr size_t kSimdWidth = 16;
+constexpr unsigned kHexBase = 16;
+constexpr unsigned kDecimalBase = 10;
+constexpr uint64_t kBitsPerByte = 8;
+
+// Pull tokenizer over a contiguous buffer. Keys and strings without escapes
+// are returned as views into the input; nothing is materialized until the
+// schema-aware parser below decides where a value goes.
+class JsonCursor {
+public:
+  explicit JsonCursor(llvm::StringRef input)
+      : begin_(input.begin()), pos_(input.begin()), end_(input.end()) {}
+
+  [[nodiscard]] auto failed() const -> bool { return !error_.empty(); }
+
+  auto fail(const char *message) -> bool {
+    if (error_.empty()) {
+      error_ = message;
+      error_offset_ = static_cast<size_t>(pos_ - begin_);
+    }
+    pos_ = end_;
+    return false;
+  }
+
+  auto take_error() -> llvm::Error {
+    size_t line = 1;
+    for (const char *cursor = begin_; cursor < begin_ + error_offset_;
+         ++cursor) {
+      line += *cursor == '\n' ? 1 : 0;
+    }
+    return llvm::createStringError(llvm::errc::invalid_argument,
+                                   "line %zu (offset %zu): %s", line,
+                                   error_offset_, error_.c_str());
+  }
+
+  void skip_ws() {
+    // Most tokens follow at most one space, too short for the vector scan.
+    if (pos_ < end_ && static_cast<unsigned char>(*pos_) > ' ') {
+      return;
+    }
+    if (end_ - pos_ >= 2 && *pos_ == ' ' &&
+        static_cast<unsigned char>(pos_[1]) > ' ') {
+      ++pos_;
+      return;
+    }
+#ifdef ME3_TYPEDB_SSE2
+    // Pretty-printed output is dominated by indentation runs.
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (end_ - pos_ >= static_cast<ptrdiff_t>(kSimdWidth)) {
+      __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos_));
+      __m128i ws = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                       _mm_cmpeq_epi8(chunk, newline)),
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage),
+                       _mm_cmpeq_epi8(chunk, tab)));
+      auto non_ws = static_cast<unsigned>(~_mm_movemask_epi8(ws)) & 0xFFFFU;
+      if (non_ws != 0) {
+        pos_ += std::countr_zero(non_ws);
+        return;
+      }
+      pos_ += kSimdWidth;
+    }
+#endif
+    while (pos_ < end_ &&
+           (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+      ++pos_;
+    }
+  }
+
+  auto peek() -> char {
+    skip_ws();
+    return pos_ < end_ ? *pos_ : '\0';
+  }
+
+  auto consume(char expected) -> bool {
+    if (peek() != expected) {
+      return fail("unexpected character");
+    }
+    ++pos_;
+    return true;
+  }
+
+  // Returns the string contents as a view into the input when it has no
+  // escapes, otherwise decodes into `scratch` and returns a view of it.
+  auto string(std::string &scratch) -> llvm::StringRef {
+    if (!consume('"')) {
+      return {};
+    }
+    const char *start = pos_;
+    const char *stop = find_quote_or_escape(pos_);
+    if (stop < end_ && *stop == '"') {
+      pos_ = stop + 1;
+      return {start, static_cast<size_t>(stop - start)};
+    }
+    scratch.assign(start, stop);
+    pos_ = stop;
+    while (pos_ < end_) {
+      if (*pos_ == '"') {
+        ++pos_;
+        return scratch;
+      }
+      if (!decode_escape(scratch)) {
+        return {};
+      }
+      const char *run_end = find_quote_or_escape(pos_);
+      scratch.append(pos_, run_end);
+      pos_ = run_end;
+    }
+    fail("unterminated string");
+    return {};
+  }
+
+  auto string_value(std::string &out) -> bool {
+    llvm::StringRef value = string(out);
+    if (failed()) {
+      return false;
+    }
+    if (value.data() != out.data()) {
+      out.assign(value.data(), value.size());
+    }
+    return true;
+  }
+
+  auto uint_value(uint64_t &out) -> bool {
+    skip_ws();
+    if (pos_ >= end_ || *pos_ < '0' || *pos_ > '9') {
+      return fail("expected unsigned integer");
+    }
+    uint64_t value = 0;
+    while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+      auto digit = static_cast<uint64_t>(*pos_ - '0');
+      if (value > (UINT64_MAX - digit) / kDecimalBase) {
+        return fail("integer out of range");
+      }
+      value = value * kDecimalBase + digit;
+      ++pos_;
+    }
+    out = value;
+    return true;
+  }
+
+  auto int_value(int64_t &out) -> bool {
+    skip_ws();
+    bool negative = pos_ < end_ && *pos_ == '-';
+    if (negative) {
+      ++pos_;
+    }
+    uint64_t magnitude = 0;
+    if (!uint_value(magnitude)) {
+      return false;
+    }
+    auto limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+    if (magnitude > limit) {
+      return fail("integer out of range");
+    }
+    out = negative ? static_cast<int64_t>(0 - magnitude)
+                   : static_cast<int64_t>(magnitude);
+    return true;
+  }
+
+  auto bool_value(bool &out) -> bool {
+    skip_ws();
+    if (literal("true")) {
+      out = true;
+      return true;
+    }
+    if (literal("false")) {
+      out = false;
+      return true;
+    }
+    return fail("expected boolean");
+  }
+
+  // Iterates an object, calling on_member(key) with the cursor positioned at
+  // the member's value. on_member must consume the value.
+  template <typename Fn> auto object(Fn &&on_member) -> bool {
+    if (!consume('{')) {
+      return false;
+    }
+    if (peek() == '}') {
+      ++pos_;
+      return true;
+    }
+    std::string key_scratch;
+    while (!failed()) {
+      llvm::StringRef key = string(key_scratch);
+      if (failed() || !consume(':') || !on_member(key)) {
+        return fail("malformed object member");
+      }
+      char next = peek();
+      ++pos_;
+      if (next == '}') {
+        return true;
+      }
+      if (next != ',') {
+        return fail("expected ',' or '}'");
+      }
+    }
+    return false;
+  }
+
+  template <typename Fn> auto array(Fn &&on_element) -> bool {
+    if (!consume('[')) {
+      return false;
+    }
+    if (peek() == ']') {
+      ++pos_;
+      return true;
+    }
+    while (!failed()) {
+      if (!on_element()) {
+        return fail("malformed array element");
+      }
+      char next = peek();
+      ++pos_;
+      if (next == ']') {
+        return true;
+      }
+      if (next != ',') {
+        return fail("expected ',' or ']'");
+      }
+    }
+    return false;
+  }
+
+  auto string_array(std::vector<std::string> &out) -> bool {
+    out.clear();
+    return array([&] {
+      out.emplace_back();
+      return string_value(out.back());
+    });
+  }
+
+  auto skip_value() -> bool {
+    std::string scratch;
+    switch (peek()) {
+    case '{':
+      return object([&](llvm::StringRef /*key*/) { return skip_value(); });
+    case '[':
+      return array([&] { return skip_value(); });
+    case '"':
+      string(scratch);
+      return !failed();
+    case 't':
+    case 'f':
+    case 'n':
+      if (literal("true") || literal("false") || literal("null")) {
+        return true;
+      }
+      return fail("unknown literal");
+    default:
+      return skip_number();
+    }
+  }
+
+  auto at_end() -> bool {
+    skip_ws();
+    return pos_ == end_;
+  }
+
+private:
+  auto find_quote_or_escape(const char *cursor) const -> const char * {
+#ifdef ME3_TYPEDB_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (end_ - cursor >= static_cast<ptrdiff_t>(kSimdWidth)) {
+      __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(cursor));
+      auto hits = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(
+          _mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+      if (hits != 0) {
+        return cursor + std::countr_zero(hits);
+      }
+      cursor += kSimdWidth;
+    }
+#endif
+    while (cursor < end_ && *cursor != '"' && *cursor != '\\') {
+      ++cursor;
+    }
+    return cursor;
+  }
+
+  auto skip_digits() -> bool {
+    const char *start = pos_;
+    while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+      ++pos_;
+    }
+    return pos_ != start;
+  }
+
+  // -?digits(.digits)?([eE][+-]?digits)?
+  auto skip_number() -> bool {
+    if (pos_ < end_ && *pos_ == '-') {
+      ++pos_;
+    }
+    if (!skip_digits()) {
+      return fail("unexpected character");
+    }
+    if (pos_ < end_ && *pos_ == '.') {
+      ++pos_;
+      if (!skip_digits()) {
+        return fail("malformed number");
+      }
+    }
+    if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+      ++pos_;
+      if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-')) {
+        ++pos_;
+      }
+      if (!skip_digits()) {
+        return fail("malformed number");
+      }
+    }
+    return true;
+  }
+
+  auto literal(std::string_view word) -> bool {
+    if (std::string_view(pos_, end_ - pos_).starts_with(word)) {
+      pos_ += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  auto hex4(uint32_t &out) -> bool {
+    if (end_ - pos_ < 4) {
+      return fail("truncated \\u escape");
+    }
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      char digit = *pos_++;
+      uint32_t value = 0;
+      if (digit >= '0' && digit <= '9') {
+        value = digit - '0';
+      } else if (digit >= 'a' && digit <= 'f') {
+        value = digit - 'a' + kDecimalBase;
+      } else if (digit >= 'A' && digit <= 'F') {
+        value = digit - 'A' + kDecimalBase;
+      } else {
+        return fail("invalid \\u escape");
+      }
+      out = out * kHexBase + value;
+    }
+    return true;
+  }
+
+  static void append_utf8(std::string &out, uint32_t code_point) {
+    if (code_point < 0x80) {
+      out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+      out += static_cast<char>(0xC0 | (code_point >> 6));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+      out += static_cast<char>(0xE0 | (code_point >> 12));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code_point >> 18));
+      out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+  }
+
+  // Decodes the escape sequence at pos_ (which points at the backslash).
+  auto decode_escape(std::string &out) -> bool {
+    if (end_ - pos_ < 2) {
+      return fail("truncated escape");
+    }
+    char kind = pos_[1];
+    pos_ += 2;
+    switch (kind) {
+    case '"':
+    case '\\':
+    case '/':
+      out += kind;
+      return true;
+    case 'b':
+      out += '\b';
+      return true;
+    case 'f':
+      out += '\f';
+      return true;
+    case 'n':
+      out += '\n';
+      return true;
+    case 'r':
+      out += '\r';
+      return true;
+    case 't':
+      out += '\t';
+      return true;
+    case 'u': {
+      uint32_t code_point = 0;
+      if (!hex4(code_point)) {
+        return false;
+      }
+      if (code_point >= 0xDC00 && code_point < 0xE000) {
+        return fail("unpaired surrogate");
+      }
+      if (code_point >= 0xD800 && code_point < 0xDC00) {
+        uint32_t low = 0;
+        if (end_ - pos_ < 2 || pos_[0] != '\\' || pos_[1] != 'u') {
+          return fail("unpaired surrogate");
+        }
+        pos_ += 2;
+        if (!hex4(low)) {
+          return false;
+        }
+        if (low < 0xDC00 || low >= 0xE000) {
+          return fail("unpaired surrogate");
+        }
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+      }
+      append_utf8(out, code_point);
+      return true;
+    }
+    default:
+      return fail("invalid escape");
+    }
+  }
+
+  const char *begin_;
+  const char *pos_;
+  const char *end_;
+  std::string error_;
+  size_t error_offset_ = 0;
+};
+
+// Union of every member any node kind may carry. Members arrive in any order,
+// so the node kind is only known once its object has been closed.
+struct NodeScratch {
+  std::string kind;
+  std::string name;
+  std::string cdecl;
+  std::string pointee;
+  std::string elem;
+  std::string return_type;
+  std::string underlying_type;
+  std::string original_record;
+  std::string spelling;
+  std::string primary_template;
+  bool has_primary_template = false;
+  int64_t index = 0;
+  int64_t depth = 0;
+  uint64_t size = 0;
+  uint64_t size_bytes = 0;
+  uint64_t align_bytes = 0;
+  bool variadic = false;
+  bool template_primary = false;
+  bool layout_dependent = false;
+  std::vector<std::string> params;
+  std::vector<std::string> type_args;
+  std::vector<std::string> template_type_args;
+  std::vector<ObjectField> fields;
+  std::vector<Enumerator> enumerators;
+  bool is_signed = false;
+
+  // Empties every member but keeps the buffers allocated, so the next node
+  // reuses them; take() hands out exactly sized copies.
+  void reset() {
+    for (std::string *text :
+         {&kind, &name, &cdecl, &pointee, &elem, &return_type,
+          &underlying_type, &original_record, &spelling, &primary_template}) {
+      text->clear();
+    }
+    has_primary_template = false;
+    index = 0;
+    depth = 0;
+    size = 0;
+    size_bytes = 0;
+    align_bytes = 0;
+    variadic = false;
+    template_primary = false;
+    layout_dependent = false;
+    params.clear();
+    type_args.clear();
+    template_type_args.clear();
+    fields.clear();
+    enumerators.clear();
+    is_signed = false;
+  }
+
+  template <typename T>
+  static auto take(std::vector<T> &buffer) -> std::vector<T> {
+    return std::vector<T>(std::make_move_iterator(buffer.begin()),
+                          std::make_move_iterator(buffer.end()));
+  }
+};
+
+class TypeDbJsonReader {
+public:
+  explicit TypeDbJsonReader(llvm::StringRef input) : cursor_(input) {}
+
+  auto read() -> llvm::Expected<TypeDb> {
+    if (root() && !cursor_.at_end()) {
+      cursor_.fail("trailing data after root");
+    }
+    if (cursor_.failed()) {
+      return cursor_.take_error();
+    }
+    db_.build_indices();
+    return std::move(db_);
+  }
+
+private:
+  auto root() -> bool {
+    return cursor_.object([&](llvm::StringRef key) {
+      if (key == "schema_version") {
+        std::string version;
+        if (!cursor_.string_value(version)) {
+          return false;
+        }
+        if (schema_major(version) < schema_major(LEGACY_SCHEMA_VERSION) ||
+            schema_major(version) > schema_major(SCHEMA_VERSION)) {
+          return cursor_.fail("unsupported schema_version");
+        }
+        return true;
+      }
+      if (key == "triple") {
+        return cursor_.string_value(db_.triple);
+      }
+      if (key == "pointer_width_bits") {
+        return int_member(db_.pointer_width_bits);
+      }
+      if (key == "char_width_bits") {
+        return int_member(db_.char_width_bits);
+      }
+      if (key == "long_width_bits") {
+        return int_member(db_.long_width_bits);
+      }
+      if (key == "nodes") {
+        return cursor_.object([&](llvm::StringRef name) {
+          return node(name);
+        });
+      }
+      return cursor_.skip_value();
+    });
+  }
+
+  static auto schema_major(llvm::StringRef version) -> unsigned {
+    unsigned major = 0;
+    if (version.split('.').first.getAsInteger(kDecimalBase, major)) {
+      return 0;
+    }
+    return major;
+  }
+
+  auto int_member(int &out) -> bool {
+    int64_t value = 0;
+    if (!cursor_.int_value(value)) {
+      return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+  }
+
+  auto field(ObjectField &out) -> bool {
+    out = ObjectField{};
+    out.layout_known = false;
+    return cursor_.object([&](llvm::StringRef key) {
+      if (key == "kind") {
+        llvm::StringRef kind = cursor_.string(kind_scratch_);
+        if (cursor_.failed()) {
+          return false;
+        }
+        out.is_base = kind == "base";
+        out.is_vfptr = kind == "vfptr";
+        out.is_bitfield = kind == "bitfield";
+        return true;
+      }
+      if (key == "name") {
+        return cursor_.string_value(out.name);
+      }
+      if (key == "type") {
+        return cursor_.string_value(out.type_id);
+      }
+      if (key == "size_bytes") {
+        out.layout_known = true;
+        return cursor_.uint_value(out.size_bytes);
+      }
+      if (key == "bit_width") {
+        uint64_t width = 0;
+        if (!cursor_.uint_value(width)) {
+          return false;
+        }
+        out.bit_width = width;
+        return true;
+      }
+      if (key == "is_virtual_base") {
+        return cursor_.bool_value(out.is_virtual_base);
+      }
+      // offset_bytes and bit_offset may arrive in either order.
+      if (key == "offset_bytes" || key == "bit_offset") {
+        uint64_t value = 0;
+        if (!cursor_.uint_value(value)) {
+          return false;
+        }
+        uint64_t scale = key == "offset_bytes" ? kBitsPerByte : 1;
+        out.offset_bits = out.offset_bits.value_or(0) + value * scale;
+        return true;
+      }
+      return cursor_.skip_value();
+    });
+  }
+
+  auto fields(std::vector<ObjectField> &out) -> bool {
+    out.clear();
+    return cursor_.array([&] {
+      out.emplace_back();
+      return field(out.back());
+    });
+  }
+
+  // Schema 7 stores values as JSON integers, older schemas as decimal
+  // strings. Non-negative values are read unsigned so that values of 2^63
+  // and up keep their bits; only a negative value marks the enum as signed,
+  // which older schemas have no "is_signed" key to say.
+  auto enumerator_value(uint64_t &out, bool &is_signed) -> bool {
+    int64_t value = 0;
+    if (cursor_.peek() == '"') {
+      std::string text;
+      if (!cursor_.string_value(text)) {
+        return false;
+      }
+      llvm::StringRef digits(text);
+      bool negative = digits.startswith("-");
+      bool failed = negative ? digits.getAsInteger(kDecimalBase, value)
+                             : digits.getAsInteger(kDecimalBase, out);
+      if (failed) {
+        return cursor_.fail("invalid enumerator value");
+      }
+      if (!negative) {
+        return true;
+      }
+    } else if (cursor_.peek() != '-') {
+      return cursor_.uint_value(out);
+    } else if (!cursor_.int_value(value)) {
+      return false;
+    }
+    out = static_cast<uint64_t>(value);
+    is_signed |= value < 0;
+    return true;
+  }
+
+  auto enumerators(std::vector<Enumerator> &out, bool &is_signed) -> bool {
+    out.clear();
+    return cursor_.array([&] {
+      out.emplace_back();
+      return cursor_.object([&](llvm::StringRef key) {
+        if (key == "name") {
+          return cursor_.string_value(out.back().name);
+        }
+        if (key == "value") {
+          return enumerator_value(out.back().value, is_signed);
+        }
+        return cursor_.skip_value();
+      });
+    });
+  }
+
+  auto node_member(llvm::StringRef key) -> bool {
+    NodeScratch &s = scratch_;
+    if (key == "kind") {
+      return cursor_.string_value(s.kind);
+    }
+    if (key == "name") {
+      return cursor_.string_value(s.name);
+    }
+    if (key == "cdecl") {
+      return cursor_.string_value(s.cdecl);
+    }
+    if (key == "pointee") {
+      return cursor_.string_value(s.pointee);
+    }
+    if (key == "elem") {
+      return cursor_.string_value(s.elem);
+    }
+    if (key == "return_type") {
+      return cursor_.string_value(s.return_type);
+    }
+    if (key == "underlying_type") {
+      return cursor_.string_value(s.underlying_type);
+    }
+    if (key == "original_record") {
+      return cursor_.string_value(s.original_record);
+    }
+    if (key == "spelling") {
+      return cursor_.string_value(s.spelling);
+    }
+    if (key == "primary_template") {
+      s.has_primary_template = true;
+      return cursor_.string_value(s.primary_template);
+    }
+    if (key == "index") {
+      return cursor_.int_value(s.index);
+    }
+    if (key == "depth") {
+      return cursor_.int_value(s.depth);
+    }
+    if (key == "size") {
+      return cursor_.uint_value(s.size);
+    }
+    if (key == "size_bytes") {
+      return cursor_.uint_value(s.size_bytes);
+    }
+    if (key == "align_bytes") {
+      return cursor_.uint_value(s.align_bytes);
+    }
+    if (key == "variadic") {
+      return cursor_.bool_value(s.variadic);
+    }
+    if (key == "template_primary") {
+      return cursor_.bool_value(s.template_primary);
+    }
+    if (key == "layout_dependent") {
+      return cursor_.bool_value(s.layout_dependent);
+    }
+    if (key == "params") {
+      return cursor_.string_array(s.params);
+    }
+    if (key == "type_args") {
+      return cursor_.string_array(s.type_args);
+    }
+    if (key == "template_type_args") {
+      return cursor_.string_array(s.template_type_args);
+    }
+    if (key == "fields" || key == "entries") {
+      return fields(s.fields);
+    }
+    if (key == "is_signed") {
+      bool is_signed = false;
+      if (!cursor_.bool_value(is_signed)) {
+        return false;
+      }
+      s.is_signed |= is_signed;
+      return true;
+    }
+    if (key == "enumerators") {
+      return enumerators(s.enumerators, s.is_signed);
+    }
+    return cursor_.skip_value();
+  }
+
+  auto node(llvm::StringRef name) -> bool {
+    scratch_.reset();
+    if (!cursor_.object(
+            [&](llvm::StringRef key) { return node_member(key); })) {
+      return false;
+    }
+    NodeScratch &s = scratch_;
+    Node out;
+    out.name = name.str();
+    // Schema 5 spelled out cdecl even when it matched the name.
+    if (s.cdecl != out.name) {
+      out.cdecl = std::move(s.cdecl);
+    }
+    if (s.kind == "builtin") {
+      out.data = BuiltinType{std::move(s.name)};
+    } else if (s.kind == "template_param") {
+      out.data = TemplateParameterType{.index = static_cast<int>(s.index),
+                                       .depth = static_cast<int>(s.depth),
+                                       .name = std::move(s.name)};
+    } else if (s.kind == "pointer") {
+      out.data = PointerType{std::move(s.pointee)};
+    } else if (s.kind == "const_array") {
+      out.data = FixedSizeArrayType{.size = s.size, .elem = std::move(s.elem)};
+    } else if (s.kind == "incomplete_array") {
+      out.data = UnsizedArrayType{std::move(s.elem)};
+    } else if (s.kind == "function") {
+      out.data = FunctionType{.return_type = std::move(s.return_type),
+                              .params = NodeScratch::take(s.params),
+                              .variadic = s.variadic};
+    } else if (s.kind == "template_specialization") {
+      out.data = TemplateSpecializationType{.name = std::move(s.name),
+                                            .type_args =
+                                                NodeScratch::take(s.type_args)};
+    } else if (s.kind == "object") {
+      ObjectType object;
+      object.size_bytes = s.size_bytes;
+      object.align_bytes = s.align_bytes;
+      object.template_primary = s.template_primary;
+      object.layout_dependent = s.layout_dependent;
+      object.template_type_args = NodeScratch::take(s.template_type_args);
+      if (s.has_primary_template) {
+        object.primary_template = std::move(s.primary_template);
+      }
+      object.fields = NodeScratch::take(s.fields);
+      out.data = std::move(object);
+    } else if (s.kind == "enum") {
+      // is_flags and value_order are derived data and rebuilt here.
+      EnumType enum_data{.size_bytes = s.size_bytes,
+                         .align_bytes = s.align_bytes,
+                         .underlying_type = std::move(s.underlying_type),
+                         .is_signed = s.is_signed,
+                         .is_flags = false,
+                         .enumerators = NodeScratch::take(s.enumerators),
+                         .value_order = {}};
+      enum_data.build_value_order();
+      out.data = std::move(enum_data);
+    } else if (s.kind == "vftable") {
+      out.data = VfTableType{.original_record = std::move(s.original_record),
+                             .size_bytes = s.size_bytes,
+                             .align_bytes = s.align_bytes,
+                             .fields = NodeScratch::take(s.fields)};
+    } else if (s.kind == "unknown") {
+      out.data = UnknownType{std::move(s.spelling)};
+    } else {
+      return cursor_.fail("unknown node kind");
+    }
+    db_.nodes.push_back(std::move(out));
+    return true;
+  }
+
+  JsonCursor cursor_;
+  NodeScratch scratch_;
+  std::string kind_scratch_;
+  TypeDb db_;
+};
+
+} // namespace
+
+auto typedb_from_json(llvm::StringRef json) -> llvm::Expected<TypeDb> {
+  return TypeDbJsonReader(json).read();
+}
+
+auto load_typedb_file(llvm::StringRef path) -> llvm::Expected<TypeDb> {
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> contents =
+      read_input(path);
+  if (!contents) {
+    return contents.takeError();
+  }
+  llvm::Expected<TypeDb> type_db = typedb_from_json((*contents)->getBuffer());
+  if (!type_db) {
+    return llvm::createFileError(path, type_db.takeError());
+  }
+  return type_db;
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,103 @@
+#include "typedb.h"
+#include "typedb_json.h"
+#include "typedb_test.h"
+#include <llvm/Support/Error.h>
+#include <string>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto document(const std::string &nodes, const std::string &extra = {})
+    -> std::string {
+  return R"({"schema_version": "7.0.0", "triple": "x86_64-pc-windows-msvc",
+            "pointer_width_bits": 64, "char_width_bits": 8,
+            "long_width_bits": 32)" +
+         extra + R"(, "nodes": {)" + nodes + "}}";
+}
+
+auto parses(const std::string &json) -> bool {
+  llvm::Expected<TypeDb> db = typedb_from_json(json);
+  if (!db) {
+    llvm::consumeError(db.takeError());
+    return false;
+  }
+  return true;
+}
+
+void test_root() {
+  TYPEDB_CHECK(parses(document("")));
+  TYPEDB_CHECK(!parses("[" + document("") + "]"));
+  TYPEDB_CHECK(!parses(document("") + " {}"));
+  TYPEDB_CHECK(!parses(R"({"schema_version": "4.0.0", "nodes": {}})"));
+  TYPEDB_CHECK(!parses(R"({"schema_version": "8.0.0", "nodes": {}})"));
+}
+
+void test_skipped_values() {
+  TYPEDB_CHECK(parses(document(
+      "", R"(, "extra": [1, -2.5, 3e8, 4.0E-2, true, null, {"a": "b"}])")));
+  for (const char *bad : {"-", "+1", "1.", ".5", "1e", "1e+", "--1", "x",
+                          "]", "nul", "'a'"}) {
+    TYPEDB_CHECK(!parses(document("", std::string(R"(, "extra": )") + bad)));
+  }
+}
+
+void test_integers() {
+  auto node = [](const std::string &size) {
+    return document(R"("int[]": {"kind": "const_array", "elem": "int",
+                                 "size": )" +
+                    size + "}");
+  };
+  llvm::Expected<TypeDb> db = typedb_from_json(node("18446744073709551615"));
+  TYPEDB_CHECK(static_cast<bool>(db));
+  if (db) {
+    TYPEDB_CHECK_EQ(std::get<FixedSizeArrayType>(db->nodes.at(0).data).size,
+                    UINT64_MAX);
+  } else {
+    llvm::consumeError(db.takeError());
+  }
+  TYPEDB_CHECK(!parses(node("18446744073709551616")));
+  TYPEDB_CHECK(!parses(node("99999999999999999999")));
+  TYPEDB_CHECK(!parses(node("-1")));
+
+  auto param = [](const std::string &index) {
+    return document(R"("T": {"kind": "template_param", "name": "T",
+                             "depth": 0, "index": )" +
+                    index + "}");
+  };
+  TYPEDB_CHECK(parses(param("-9223372036854775808")));
+  TYPEDB_CHECK(!parses(param("9223372036854775808")));
+  TYPEDB_CHECK(!parses(param("-9223372036854775809")));
+}
+
+void test_strings() {
+  llvm::Expected<TypeDb> db = typedb_from_json(
+      document(R"("a\"b": {"kind": "builtin", "name": "é😀"})"));
+  TYPEDB_CHECK(static_cast<bool>(db));
+  if (db) {
+    TYPEDB_CHECK_EQ(db->nodes.at(0).name, std::string("a\"b"));
+    TYPEDB_CHECK_EQ(std::get<BuiltinType>(db->nodes.at(0).data).name,
+                    std::string("\xC3\xA9\xF0\x9F\x98\x80"));
+  } else {
+    llvm::consumeError(db.takeError());
+  }
+  auto builtin = [](const std::string &name) {
+    return document(R"("x": {"kind": "builtin", "name": ")" + name + R"("})");
+  };
+  TYPEDB_CHECK(!parses(builtin(R"(\ude00)")));
+  TYPEDB_CHECK(!parses(builtin(R"(\ud83d)")));
+  TYPEDB_CHECK(!parses(builtin(R"(\ud83dA)")));
+  TYPEDB_CHECK(!parses(builtin(R"(\q)")));
+  TYPEDB_CHECK(!parses(builtin(R"(\u12)")));
+  TYPEDB_CHECK(!parses(R"({"nodes": {"x": {"kind": "builtin", "name": "ab)"));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_root();
+  test_skipped_values();
+  test_integers();
+  test_strings();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,274 @@
+#include "typedb.h"
+#include "typedb_json.h"
+#include "typedb_test.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto make_node(std::string name, NodeVariant data, std::string cdecl = {})
+    -> Node {
+  Node node;
+  node.name = std::move(name);
+  node.data = std::move(data);
+  node.cdecl = std::move(cdecl);
+  return node;
+}
+
+auto make_field(std::string name, uint64_t offset_bits) -> ObjectField {
+  ObjectField field;
+  field.name = std::move(name);
+  field.size_bytes = 4;
+  field.offset_bits = offset_bits;
+  field.type_id = "int";
+  return field;
+}
+
+auto sample_nodes() -> std::vector<Node> {
+  std::vector<Node> nodes;
+  nodes.push_back(make_node("int", BuiltinType{"int"}));
+  nodes.push_back(make_node("int *", PointerType{"int"}));
+  nodes.push_back(make_node("int[4]", FixedSizeArrayType{4, "int"}, "int"));
+  ObjectType object;
+  object.size_bytes = 8;
+  object.align_bytes = 4;
+  object.fields.push_back(make_field("a", 0));
+  ObjectField bits = make_field("b", 32);
+  bits.bit_width = 3;
+  bits.is_bitfield = true;
+  object.fields.push_back(std::move(bits));
+  nodes.push_back(make_node("Point", std::move(object)));
+  EnumType color;
+  color.size_bytes = 4;
+  color.align_bytes = 4;
+  color.underlying_type = "int";
+  color.enumerators = {{"Red", 0}, {"Green", 1}};
+  color.build_value_order();
+  nodes.push_back(make_node("Color", std::move(color)));
+  return nodes;
+}
+
+auto sample_db(std::vector<Node> nodes) -> TypeDb {
+  TypeDb db;
+  db.triple = "x86_64-pc-windows-msvc";
+  db.pointer_width_bits = 64;
+  db.char_width_bits = 8;
+  db.long_width_bits = 32;
+  db.nodes = std::move(nodes);
+  db.build_indices();
+  return db;
+}
+
+auto streamed(const TypeDb &db, const JsonOptions &options) -> std::string {
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  TypeDbJsonWriter writer(out, options);
+  TypeDb header = sample_db({});
+  writer.begin(header);
+  for (Node node : db.nodes) {
+    writer.node(std::move(node));
+  }
+  writer.end();
+  return out.str();
+}
+
+auto formatted(const TypeDb &db, const JsonOptions &options) -> std::string {
+  return llvm::formatv("{0:2}\n", typedb_to_json(db, options)).str();
+}
+
+void test_stream_matches_dom() {
+  // typedb_to_json sorts nodes by name; the writer keeps arrival order.
+  std::vector<Node> nodes = sample_nodes();
+  std::sort(nodes.begin(), nodes.end(), [](const Node &lhs, const Node &rhs) {
+    return lhs.name < rhs.name;
+  });
+  TypeDb db = sample_db(std::move(nodes));
+  for (bool legacy : {false, true}) {
+    JsonOptions options{.legacy_schema = legacy};
+    TYPEDB_CHECK_EQ(streamed(db, options), formatted(db, options));
+  }
+}
+
+void test_legacy_omits_offsets() {
+  TypeDb db = sample_db(sample_nodes());
+  std::string current = formatted(db, {});
+  std::string legacy = formatted(db, {.legacy_schema = true});
+  TYPEDB_CHECK(llvm::StringRef(current).contains("\"offset_bytes\""));
+  TYPEDB_CHECK(llvm::StringRef(current).contains("\"bit_offset\""));
+  TYPEDB_CHECK(!llvm::StringRef(legacy).contains("\"offset_bytes\""));
+  TYPEDB_CHECK(!llvm::StringRef(legacy).contains("\"bit_offset\""));
+}
+
+// Schema 5 as older consumers read it: enumerator values are strings,
+// cdecl is synthesised for every kind but records, enums and vftables, and
+// offsets, is_signed, is_flags and by_value do not exist yet.
+void test_legacy_golden() {
+  std::vector<Node> nodes;
+  nodes.push_back(make_node("int", BuiltinType{"int"}));
+  nodes.push_back(make_node("void (int)",
+                            FunctionType{.return_type = "void",
+                                         .params = {"int"},
+                                         .variadic = false}));
+  ObjectType point;
+  point.size_bytes = 8;
+  point.align_bytes = 4;
+  point.fields.push_back(make_field("a", 0));
+  ObjectField bits = make_field("b", 35);
+  bits.bit_width = 3;
+  bits.is_bitfield = true;
+  point.fields.push_back(std::move(bits));
+  nodes.push_back(make_node("Point", std::move(point)));
+  EnumType flags;
+  flags.size_bytes = 4;
+  flags.align_bytes = 4;
+  flags.underlying_type = "unsigned int";
+  flags.enumerators = {{"A", 1}, {"B", 2}, {"C", 4}};
+  flags.build_value_order();
+  TYPEDB_CHECK(flags.is_flags);
+  nodes.push_back(make_node("Flags", std::move(flags)));
+  EnumType sign;
+  sign.size_bytes = 4;
+  sign.align_bytes = 4;
+  sign.underlying_type = "int";
+  sign.is_signed = true;
+  sign.enumerators = {{"Zero", 0}, {"Neg", static_cast<uint64_t>(-1)}};
+  sign.build_value_order();
+  nodes.push_back(make_node("Sign", std::move(sign)));
+  VfTableType table;
+  table.original_record = "Point";
+  table.size_bytes = 8;
+  table.align_bytes = 8;
+  ObjectField get;
+  get.name = "get";
+  get.type_id = "int (*)()";
+  get.size_bytes = 8;
+  table.fields.push_back(std::move(get));
+  nodes.push_back(make_node("Point::vftable", std::move(table)));
+
+  TYPEDB_CHECK_EQ(formatted(sample_db(std::move(nodes)),
+                            {.legacy_schema = true}),
+                  std::string(R"json({
+  "char_width_bits": 8,
+  "long_width_bits": 32,
+  "nodes": {
+    "Flags": {
+      "align_bytes": 4,
+      "enumerators": [
+        {
+          "name": "A",
+          "value": "1"
+        },
+        {
+          "name": "B",
+          "value": "2"
+        },
+        {
+          "name": "C",
+          "value": "4"
+        }
+      ],
+      "kind": "enum",
+      "size_bytes": 4,
+      "underlying_type": "unsigned int"
+    },
+    "Point": {
+      "align_bytes": 4,
+      "fields": [
+        {
+          "kind": "field",
+          "name": "a",
+          "size_bytes": 4,
+          "type": "int"
+        },
+        {
+          "bit_width": 3,
+          "kind": "bitfield",
+          "name": "b",
+          "size_bytes": 4,
+          "type": "int"
+        }
+      ],
+      "kind": "object",
+      "size_bytes": 8
+    },
+    "Point::vftable": {
+      "align_bytes": 8,
+      "entries": [
+        {
+          "name": "get",
+          "size_bytes": 8,
+          "type": "int (*)()"
+        }
+      ],
+      "kind": "vftable",
+      "original_record": "Point",
+      "size_bytes": 8,
+      "synthetic": true
+    },
+    "Sign": {
+      "align_bytes": 4,
+      "enumerators": [
+        {
+          "name": "Zero",
+          "value": "0"
+        },
+        {
+          "name": "Neg",
+          "value": "-1"
+        }
+      ],
+      "kind": "enum",
+      "size_bytes": 4,
+      "underlying_type": "int"
+    },
+    "int": {
+      "cdecl": "int",
+      "kind": "builtin",
+      "name": "int"
+    },
+    "void (int)": {
+      "cdecl": "void (int)",
+      "kind": "function",
+      "params": [
+        "int"
+      ],
+      "return_type": "void"
+    }
+  },
+  "pointer_width_bits": 64,
+  "schema_version": "5.0.0",
+  "triple": "x86_64-pc-windows-msvc"
+}
+)json"));
+}
+
+void test_stream_round_trip() {
+  TypeDb db = sample_db(sample_nodes());
+  std::string text = streamed(db, {});
+  TYPEDB_CHECK(!text.empty() && text.front() == '{');
+  llvm::Expected<TypeDb> parsed = typedb_from_json(text);
+  if (!parsed) {
+    TYPEDB_CHECK_EQ(llvm::toString(parsed.takeError()), std::string());
+    return;
+  }
+  TYPEDB_CHECK_EQ(formatted(*parsed, {}), formatted(db, {}));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_stream_matches_dom();
+  test_legacy_omits_offsets();
+  test_legacy_golden();
+  test_stream_round_trip();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,232 @@
+#include "typedb_metrics.h"
+#include "typedb_interner.h"
+#include <algorithm>
+#include <fstream>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <utility>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace me3::typedb {
+namespace {
+
+constexpr double kNanosPerSecond = 1e9;
+
+auto now_ns() -> int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void write_metric(llvm::raw_ostream &out, llvm::StringRef name,
+                  llvm::StringRef type, llvm::StringRef help, double value) {
+  out << "# HELP " << name << ' ' << help << '\n'
+      << "# TYPE " << name << ' ' << type << '\n'
+      << name << ' ' << llvm::format("%.17g", value) << '\n';
+}
+
+} // namespace
+
+void PipelineMetrics::WorkerSlot::begin(size_t index) {
+  started_ns.store(now_ns(), std::memory_order_relaxed);
+  source_index.store(index, std::memory_order_relaxed);
+}
+
+void PipelineMetrics::WorkerSlot::end() {
+  source_index.store(kIdle, std::memory_order_relaxed);
+}
+
+void PipelineMetrics::start(const std::vector<std::string> &sources,
+                            unsigned workers,
+                            const TypeIdInterner *type_ids) {
+  std::lock_guard lock(mutex_);
+  sources_ = &sources;
+  type_ids_ = type_ids;
+  workers_.clear();
+  workers_.resize(workers);
+  tus_done_.store(0, std::memory_order_relaxed);
+}
+
+auto PipelineMetrics::worker(unsigned index) -> WorkerSlot & {
+  std::lock_guard lock(mutex_);
+  return workers_[index];
+}
+
+auto PipelineMetrics::snapshot() const -> MetricsSnapshot {
+  MetricsSnapshot snapshot;
+  int64_t now = now_ns();
+  {
+    std::lock_guard lock(mutex_);
+    snapshot.tus_total = sources_ != nullptr ? sources_->size() : 0;
+    snapshot.tus_done = tus_done_.load(std::memory_order_relaxed);
+    int64_t slowest_ns = -1;
+    for (const WorkerSlot &slot : workers_) {
+      snapshot.records += slot.counters.records.load(std::memory_order_relaxed);
+      snapshot.nodes += slot.counters.nodes.load(std::memory_order_relaxed);
+      size_t index = slot.source_index.load(std::memory_order_relaxed);
+      if (index == kIdle || sources_ == nullptr || index >= sources_->size()) {
+        continue;
+      }
+      ++snapshot.tus_in_flight;
+      int64_t elapsed = now - slot.started_ns.load(std::memory_order_relaxed);
+      if (elapsed > slowest_ns) {
+        slowest_ns = elapsed;
+        snapshot.slowest_source = (*sources_)[index];
+      }
+    }
+    if (slowest_ns >= 0) {
+      snapshot.slowest_seconds =
+          static_cast<double>(slowest_ns) / kNanosPerSecond;
+    }
+    if (type_ids_ != nullptr) {
+      snapshot.interned_type_ids = type_ids_->size();
+    }
+  }
+  snapshot.resident_bytes = resident_memory_bytes();
+  return snapshot;
+}
+
+auto resident_memory_bytes() -> uint64_t {
+#ifdef __linux__
+  // statm: total program size, then resident pages.
+  std::ifstream statm("/proc/self/statm");
+  uint64_t total_pages = 0;
+  uint64_t resident_pages = 0;
+  if (statm >> total_pages >> resident_pages) {
+    return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+void write_prometheus(const MetricsSnapshot &snapshot,
+                      llvm::raw_ostream &out) {
+  auto as_double = [](auto value) { return static_cast<double>(value); };
+  write_metric(out, "me3_typedb_tus", "gauge",
+               "Translation units scheduled in this run.",
+               as_double(snapshot.tus_total));
+  write_metric(out, "me3_typedb_tus_completed_total", "counter",
+               "Translation units finished, successfully or not.",
+               as_double(snapshot.tus_done));
+  uint64_t remaining = snapshot.tus_total > snapshot.tus_done
+                           ? snapshot.tus_total - snapshot.tus_done
+                           : 0;
+  write_metric(out, "me3_typedb_tus_remaining", "gauge",
+               "Translation units not finished yet, including those in "
+               "flight.",
+               as_double(remaining));
+  write_metric(out, "me3_typedb_tus_in_flight", "gauge",
+               "Translation units being parsed right now.",
+               as_double(snapshot.tus_in_flight));
+  write_metric(out, "me3_typedb_records_built_total", "counter",
+               "Record nodes built.", as_double(snapshot.records));
+  write_metric(out, "me3_typedb_nodes_built_total", "counter",
+               "Nodes of all kinds built.", as_double(snapshot.nodes));
+  write_metric(out, "me3_typedb_records_per_second", "gauge",
+               "Records built per second since the previous report.",
+               snapshot.records_per_second);
+  write_metric(out, "me3_typedb_nodes_per_second", "gauge",
+               "Nodes built per second since the previous report.",
+               snapshot.nodes_per_second);
+  write_metric(out, "me3_typedb_interned_type_ids", "gauge",
+               "Distinct type id strings in the run's shared interner.",
+               as_double(snapshot.interned_type_ids));
+  write_metric(out, "me3_typedb_resident_memory_bytes", "gauge",
+               "Resident set size of the process.",
+               as_double(snapshot.resident_bytes));
+  // The source itself would make a new series per translation unit; it is
+  // only reported on the progress line.
+  write_metric(out, "me3_typedb_slowest_in_flight_tu_seconds", "gauge",
+               "Time spent so far on the longest running translation unit, "
+               "0 when none is.",
+               snapshot.slowest_seconds);
+}
+
+void write_progress_line(const MetricsSnapshot &snapshot,
+                         llvm::raw_ostream &out) {
+  constexpr double kBytesPerMiB = 1024.0 * 1024.0;
+  out << "[" << snapshot.tus_done << "/" << snapshot.tus_total << " TUs, "
+      << snapshot.tus_in_flight << " in flight] "
+      << llvm::format("%.1f", snapshot.records_per_second) << " records/s, "
+      << llvm::format("%.1f", snapshot.nodes_per_second) << " nodes/s, "
+      << snapshot.interned_type_ids << " type ids, "
+      << llvm::format("%.1f", static_cast<double>(snapshot.resident_bytes) /
+                                  kBytesPerMiB)
+      << " MiB RSS";
+  if (!snapshot.slowest_source.empty()) {
+    out << ", slowest " << snapshot.slowest_source << " ("
+        << llvm::format("%.1f", snapshot.slowest_seconds) << "s)";
+  }
+  out << "\n";
+}
+
+MetricsReporter::MetricsReporter(const PipelineMetrics &metrics,
+                                 MetricsReporterOptions options)
+    : metrics_(metrics), options_(std::move(options)),
+      last_time_(std::chrono::steady_clock::now()) {
+  thread_ = std::thread([this] {
+    std::unique_lock lock(mutex_);
+    while (!wake_.wait_for(lock, options_.interval,
+                           [this] { return stopping_; })) {
+      report();
+    }
+  });
+}
+
+MetricsReporter::~MetricsReporter() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+  report();
+}
+
+void MetricsReporter::report() {
+  MetricsSnapshot snapshot = metrics_.snapshot();
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - last_time_).count();
+  if (elapsed > 0 && snapshot.records >= last_records_ &&
+      snapshot.nodes >= last_nodes_) {
+    snapshot.records_per_second =
+        static_cast<double>(snapshot.records - last_records_) / elapsed;
+    snapshot.nodes_per_second =
+        static_cast<double>(snapshot.nodes - last_nodes_) / elapsed;
+  }
+  last_time_ = now;
+  last_records_ = snapshot.records;
+  last_nodes_ = snapshot.nodes;
+
+  if (options_.progress) {
+    write_progress_line(snapshot, llvm::errs());
+  }
+  if (!options_.prometheus_path.empty()) {
+    // Write then rename so scrapers never see a partial file.
+    std::string temp_path = options_.prometheus_path + ".tmp";
+    {
+      std::error_code error;
+      llvm::raw_fd_ostream out(temp_path, error, llvm::sys::fs::OF_Text);
+      if (error) {
+        llvm::errs() << temp_path << ": " << error.message() << "\n";
+        return;
+      }
+      write_prometheus(snapshot, out);
+      out.close();
+      if (out.has_error()) {
+        llvm::errs() << temp_path << ": " << out.error().message() << "\n";
+        out.clear_error();
+        return;
+      }
+    }
+    if (std::error_code error =
+            llvm::sys::fs::rename(temp_path, options_.prometheus_path)) {
+      llvm::errs() << options_.prometheus_path << ": " << error.message()
+                   << "\n";
+    }
+  }
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <llvm/Support/raw_ostream.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace me3::typedb {
+
+class TypeIdInterner;
+
+// Progress of one build thread. Each instance has a single writer, so bumps
+// are a relaxed load and store rather than a locked read-modify-write; a
+// reporter may read them at any time.
+struct BuildCounters {
+  std::atomic<uint64_t> records{0};
+  std::atomic<uint64_t> nodes{0};
+
+  static void bump(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+  }
+};
+
+struct MetricsSnapshot {
+  size_t tus_total = 0;
+  uint64_t tus_done = 0;
+  size_t tus_in_flight = 0;
+  uint64_t records = 0;
+  uint64_t nodes = 0;
+  double records_per_second = 0;
+  double nodes_per_second = 0;
+  size_t interned_type_ids = 0;
+  uint64_t resident_bytes = 0;
+  // Empty when no translation unit is being parsed. Only shown on the
+  // progress line, never as a Prometheus label.
+  std::string slowest_source;
+  double slowest_seconds = 0;
+};
+
+// Live state of a run_pipeline call, shared between its parse workers and a
+// MetricsReporter.
+class PipelineMetrics {
+public:
+  static constexpr size_t kIdle = std::numeric_limits<size_t>::max();
+
+  struct WorkerSlot {
+    BuildCounters counters;
+    // Source being parsed and when it started, or kIdle.
+    std::atomic<size_t> source_index{kIdle};
+    std::atomic<int64_t> started_ns{0};
+
+    void begin(size_t index);
+    void end();
+  };
+
+  // Called by run_pipeline before its workers start; `sources` and
+  // `type_ids`, the interner the workers build with if any, must outlive
+  // every later snapshot().
+  void start(const std::vector<std::string> &sources, unsigned workers,
+             const TypeIdInterner *type_ids = nullptr);
+  auto worker(unsigned index) -> WorkerSlot &;
+  void finish_tu() { tus_done_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Totals across all workers; rates are left to the caller.
+  [[nodiscard]] auto snapshot() const -> MetricsSnapshot;
+
+private:
+  mutable std::mutex mutex_;
+  const std::vector<std::string> *sources_ = nullptr;
+  const TypeIdInterner *type_ids_ = nullptr;
+  // A deque so slots never move once handed to a worker.
+  std::deque<WorkerSlot> workers_;
+  std::atomic<uint64_t> tus_done_{0};
+};
+
+// Resident set size of this process, or 0 where it cannot be determined.
+auto resident_memory_bytes() -> uint64_t;
+
+// Prometheus text exposition format, suitable for the node exporter's
+// textfile collector.
+void write_prometheus(const MetricsSnapshot &snapshot, llvm::raw_ostream &out);
+
+// One human-readable status line.
+void write_progress_line(const MetricsSnapshot &snapshot,
+                         llvm::raw_ostream &out);
+
+struct MetricsReporterOptions {
+  // Rewritten atomically (write, then rename) on every report.
+  std::string prometheus_path;
+  // Print write_progress_line output to stderr on every report.
+  bool progress = false;
+  std::chrono::milliseconds interval{std::chrono::seconds(10)};
+};
+
+// Background thread that snapshots `metrics` every interval, and once more
+// when destroyed.
+class MetricsReporter {
+public:
+  MetricsReporter(const PipelineMetrics &metrics,
+                  MetricsReporterOptions options);
+  MetricsReporter(const MetricsReporter &) = delete;
+  auto operator=(const MetricsReporter &) -> MetricsReporter & = delete;
+  ~MetricsReporter();
+
+private:
+  void report();
+
+  const PipelineMetrics &metrics_;
+  MetricsReporterOptions options_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::chrono::steady_clock::time_point last_time_;
+  uint64_t last_records_ = 0;
+  uint64_t last_nodes_ = 0;
+  std::thread thread_;
+};
+
+} // namespace me3::typedb
@@ -0,0 +1,131 @@
+#include "typedb_interner.h"
+#include "typedb_metrics.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto prometheus(const MetricsSnapshot &snapshot) -> std::string {
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  write_prometheus(snapshot, out);
+  return out.str();
+}
+
+// Value of the sample line for `name`, or empty when there is none.
+auto sample(const std::string &text, llvm::StringRef name) -> std::string {
+  llvm::SmallVector<llvm::StringRef> lines;
+  llvm::StringRef(text).split(lines, '\n');
+  for (llvm::StringRef line : lines) {
+    auto [metric, value] = line.split(' ');
+    if (metric == name) {
+      return value.str();
+    }
+  }
+  return {};
+}
+
+void test_exposition_format() {
+  MetricsSnapshot snapshot;
+  snapshot.tus_total = 10;
+  snapshot.tus_done = 4;
+  snapshot.tus_in_flight = 2;
+  snapshot.records = 120;
+  snapshot.nodes = 3000;
+  snapshot.records_per_second = 1.5;
+  snapshot.interned_type_ids = 77;
+  snapshot.slowest_source = "C:\\src\\\"quoted\".cpp";
+  snapshot.slowest_seconds = 2.25;
+  std::string text = prometheus(snapshot);
+
+  // Every family is a HELP line, a TYPE line and one unlabelled sample.
+  llvm::SmallVector<llvm::StringRef> lines;
+  llvm::StringRef(text).trim().split(lines, '\n');
+  TYPEDB_CHECK_EQ(lines.size() % 3, size_t{0});
+  for (size_t i = 0; i + 2 < lines.size(); i += 3) {
+    std::string name = lines[i + 2].split(' ').first.str();
+    TYPEDB_CHECK(lines[i].startswith("# HELP " + name + " "));
+    TYPEDB_CHECK(lines[i + 1] == "# TYPE " + name + " gauge" ||
+                 lines[i + 1] == "# TYPE " + name + " counter");
+    TYPEDB_CHECK(llvm::StringRef(name).startswith("me3_typedb_"));
+    TYPEDB_CHECK(name.find('{') == std::string::npos);
+  }
+  TYPEDB_CHECK(!llvm::StringRef(text).contains("quoted"));
+
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_tus"), std::string("10"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_tus_completed_total"),
+                  std::string("4"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_tus_remaining"), std::string("6"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_tus_in_flight"), std::string("2"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_records_per_second"),
+                  std::string("1.5"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_interned_type_ids"),
+                  std::string("77"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_slowest_in_flight_tu_seconds"),
+                  std::string("2.25"));
+
+  // The series stay present, at 0, once the run is idle.
+  text = prometheus(MetricsSnapshot{});
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_tus_remaining"), std::string("0"));
+  TYPEDB_CHECK_EQ(sample(text, "me3_typedb_slowest_in_flight_tu_seconds"),
+                  std::string("0"));
+}
+
+void test_pipeline_snapshot() {
+  std::vector<std::string> sources = {"a.cpp", "b.cpp", "c.cpp"};
+  TypeIdInterner type_ids;
+  type_ids.intern("int");
+  type_ids.intern("int *");
+  PipelineMetrics metrics;
+  metrics.start(sources, 2, &type_ids);
+
+  PipelineMetrics::WorkerSlot &first = metrics.worker(0);
+  PipelineMetrics::WorkerSlot &second = metrics.worker(1);
+  first.begin(0);
+  second.begin(2);
+  BuildCounters::bump(first.counters.records, 3);
+  BuildCounters::bump(second.counters.nodes, 40);
+  first.end();
+  metrics.finish_tu();
+
+  MetricsSnapshot snapshot = metrics.snapshot();
+  TYPEDB_CHECK_EQ(snapshot.tus_total, size_t{3});
+  TYPEDB_CHECK_EQ(snapshot.tus_done, uint64_t{1});
+  TYPEDB_CHECK_EQ(snapshot.tus_in_flight, size_t{1});
+  TYPEDB_CHECK_EQ(snapshot.records, uint64_t{3});
+  TYPEDB_CHECK_EQ(snapshot.nodes, uint64_t{40});
+  TYPEDB_CHECK_EQ(snapshot.interned_type_ids, size_t{2});
+  TYPEDB_CHECK_EQ(snapshot.slowest_source, std::string("c.cpp"));
+  TYPEDB_CHECK(snapshot.slowest_seconds >= 0);
+
+  std::string line;
+  llvm::raw_string_ostream out(line);
+  write_progress_line(snapshot, out);
+  TYPEDB_CHECK(
+      llvm::StringRef(out.str()).startswith("[1/3 TUs, 1 in flight]"));
+  TYPEDB_CHECK(llvm::StringRef(line).contains("slowest c.cpp"));
+
+  second.end();
+  metrics.finish_tu();
+  snapshot = metrics.snapshot();
+  TYPEDB_CHECK_EQ(snapshot.tus_in_flight, size_t{0});
+  TYPEDB_CHECK(snapshot.slowest_source.empty());
+
+  PipelineMetrics without_interner;
+  without_interner.start(sources, 1);
+  TYPEDB_CHECK_EQ(without_interner.snapshot().interned_type_ids, size_t{0});
+}
+
+} // namespace
+
+auto main() -> int {
+  test_exposition_format();
+  test_pipeline_snapshot();
+  return me3::typedb::test::test_result();
+}
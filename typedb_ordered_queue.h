@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace me3::typedb {
+
+// Hands items produced out of order by several threads to one consumer in
+// index order. Every index from 0 up must be pushed exactly once, with
+// std::nullopt for indices that produced nothing. A producer whose index is
+// `window` or more past the next one to be consumed blocks until the
+// consumer catches up, which bounds the number of buffered items.
+template <typename T> class OrderedQueue {
+public:
+  explicit OrderedQueue(size_t window) : window_(std::max<size_t>(1, window)) {}
+
+  void push(size_t index, std::optional<T> &&value) {
+    std::unique_lock lock(mutex_);
+    space_.wait(lock, [&] { return index < next_ + window_; });
+    size_t slot = index - next_;
+    if (slot >= slots_.size()) {
+      slots_.resize(slot + 1);
+    }
+    slots_[slot].ready = true;
+    slots_[slot].value = std::move(value);
+    if (slot == 0) {
+      ready_.notify_one();
+    }
+  }
+
+  // Blocks until the next index has been pushed, skipping indices pushed as
+  // std::nullopt. Empty once closed and every pushed item is consumed.
+  auto pop() -> std::optional<T> {
+    std::unique_lock lock(mutex_);
+    while (true) {
+      ready_.wait(lock, [&] {
+        return (!slots_.empty() && slots_.front().ready) || closed_;
+      });
+      if (slots_.empty() || !slots_.front().ready) {
+        return std::nullopt;
+      }
+      std::optional<T> value = std::move(slots_.front().value);
+      slots_.pop_front();
+      ++next_;
+      space_.notify_all();
+      if (value) {
+        return value;
+      }
+    }
+  }
+
+  // Called once every producer has finished.
+  void close() {
+    std::lock_guard lock(mutex_);
+    closed_ = true;
+    ready_.notify_all();
+  }
+
+private:
+  struct Slot {
+    bool ready = false;
+    std::optional<T> value;
+  };
+
+  size_t window_;
+  size_t next_ = 0;
+  // slots_[i] holds index next_ + i.
+  std::deque<Slot> slots_;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable space_;
+};
+
+} // namespace me3::typedb
@@ -0,0 +1,95 @@
+#include "typedb_ordered_queue.h"
+#include "typedb_test.h"
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using me3::typedb::OrderedQueue;
+
+namespace {
+
+void test_reorders_single_thread() {
+  OrderedQueue<int> queue(8);
+  queue.push(2, 20);
+  queue.push(0, 0);
+  queue.push(3, std::nullopt);
+  queue.push(1, 10);
+  queue.push(4, 40);
+  queue.close();
+  std::vector<int> popped;
+  while (std::optional<int> value = queue.pop()) {
+    popped.push_back(*value);
+  }
+  TYPEDB_CHECK(popped == std::vector<int>({0, 10, 20, 40}));
+}
+
+void test_reorders_across_threads() {
+  constexpr size_t kItems = 200;
+  constexpr unsigned kProducers = 4;
+  OrderedQueue<size_t> queue(kProducers + 1);
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> producers;
+  for (unsigned i = 0; i < kProducers; ++i) {
+    producers.emplace_back([&] {
+      for (size_t index = next++; index < kItems; index = next++) {
+        // Later indices tend to finish first.
+        if (index % 3 == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        queue.push(index, index % 7 == 0 ? std::nullopt
+                                         : std::optional<size_t>(index));
+      }
+    });
+  }
+  std::vector<size_t> popped;
+  std::thread consumer([&] {
+    while (std::optional<size_t> value = queue.pop()) {
+      popped.push_back(*value);
+    }
+  });
+  for (std::thread &producer : producers) {
+    producer.join();
+  }
+  queue.close();
+  consumer.join();
+
+  std::vector<size_t> expected;
+  for (size_t index = 0; index < kItems; ++index) {
+    if (index % 7 != 0) {
+      expected.push_back(index);
+    }
+  }
+  TYPEDB_CHECK(popped == expected);
+}
+
+void test_window_blocks_producers() {
+  OrderedQueue<int> queue(2);
+  queue.push(1, 1);
+  std::atomic<bool> pushed{false};
+  std::thread producer([&] {
+    queue.push(2, 2);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  TYPEDB_CHECK(!pushed);
+  queue.push(0, 0);
+  TYPEDB_CHECK_EQ(queue.pop().value_or(-1), 0);
+  producer.join();
+  TYPEDB_CHECK(pushed);
+  TYPEDB_CHECK_EQ(queue.pop().value_or(-1), 1);
+  TYPEDB_CHECK_EQ(queue.pop().value_or(-1), 2);
+  queue.close();
+  TYPEDB_CHECK(!queue.pop());
+}
+
+} // namespace
+
+auto main() -> int {
+  test_reorders_single_thread();
+  test_reorders_across_threads();
+  test_window_blocks_producers();
+  return me3::typedb::test::test_result();
+}
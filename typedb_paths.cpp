@@ -0,0 +1,67 @@
+#include "typedb_paths.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <string_view>
+
+namespace me3::typedb {
+
+PathFilter::PathFilter(const std::vector<std::string> &allow,
+                       const std::vector<std::string> &deny) {
+  for (const std::string &path : allow) {
+    allow_.push_back(normalize(path));
+  }
+  for (const std::string &path : deny) {
+    deny_.push_back(normalize(path));
+  }
+}
+
+auto PathFilter::allows(llvm::StringRef path) const -> bool {
+  if (empty()) {
+    return true;
+  }
+  std::string normalized = normalize(path);
+  if (matches_any(normalized, deny_)) {
+    return false;
+  }
+  return allow_.empty() || matches_any(normalized, allow_);
+}
+
+auto PathFilter::normalize(llvm::StringRef path) -> std::string {
+  llvm::SmallString<256> buffer(path);
+  // Without a working directory the path stays relative and can only match
+  // relative prefixes.
+  (void)llvm::sys::fs::make_absolute(buffer);
+  llvm::sys::path::remove_dots(buffer, /*remove_dot_dot=*/true);
+  std::string normalized = llvm::sys::path::convert_to_slash(buffer);
+  // Keep "/" and "C:/" as they are; drop the separator after anything else.
+  while (normalized.size() > 1 && normalized.back() == '/' &&
+         normalized[normalized.size() - 2] != ':') {
+    normalized.pop_back();
+  }
+#ifdef _WIN32
+  // Windows file systems are case-insensitive by default.
+  return llvm::StringRef(normalized).lower();
+#else
+  return normalized;
+#endif
+}
+
+auto PathFilter::matches_any(llvm::StringRef path,
+                             const std::vector<std::string> &prefixes)
+    -> bool {
+  std::string_view view(path.data(), path.size());
+  for (const std::string &prefix : prefixes) {
+    if (!view.starts_with(prefix)) {
+      continue;
+    }
+    if (view.size() == prefix.size() || prefix.back() == '/' ||
+        view[prefix.size()] == '/') {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,38 @@
+#pragma once
+#include <llvm/ADT/StringRef.h>
+#include <string>
+#include <vector>
+
+namespace me3::typedb {
+
+// Allow/deny filter over source file paths. Both the configured prefixes and
+// the queried paths are made absolute, stripped of "." and ".." components,
+// converted to forward slashes, and on Windows folded to lower case. A
+// prefix only matches whole path components, so "/foo" covers "/foo/x.h"
+// but not "/foobar/x.h".
+class PathFilter {
+public:
+  PathFilter() = default;
+  PathFilter(const std::vector<std::string> &allow,
+             const std::vector<std::string> &deny);
+
+  // True when no prefixes are configured and every path is allowed.
+  [[nodiscard]] auto empty() const -> bool {
+    return allow_.empty() && deny_.empty();
+  }
+
+  // Relative paths are resolved against the current working directory;
+  // callers that know a better base should make them absolute first.
+  [[nodiscard]] auto allows(llvm::StringRef path) const -> bool;
+
+  [[nodiscard]] static auto normalize(llvm::StringRef path) -> std::string;
+
+private:
+  static auto matches_any(llvm::StringRef path,
+                          const std::vector<std::string> &prefixes) -> bool;
+
+  std::vector<std::string> allow_;
+  std::vector<std::string> deny_;
+};
+
+} // namespace me3::typedb
@@ -0,0 +1,89 @@
+#include "typedb_paths.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+
+using me3::typedb::PathFilter;
+
+namespace {
+
+void test_component_boundary() {
+  PathFilter filter({}, {"/foo"});
+  TYPEDB_CHECK(!filter.allows("/foo"));
+  TYPEDB_CHECK(!filter.allows("/foo/x.h"));
+  TYPEDB_CHECK(filter.allows("/foobar/x.h"));
+  TYPEDB_CHECK(filter.allows("/fo/x.h"));
+
+  PathFilter trailing({}, {"/foo/"});
+  TYPEDB_CHECK(!trailing.allows("/foo/x.h"));
+  TYPEDB_CHECK(trailing.allows("/foobar/x.h"));
+}
+
+void test_dots() {
+  PathFilter filter({}, {"/sdk/include"});
+  TYPEDB_CHECK(!filter.allows("/sdk/src/../include/windows.h"));
+  TYPEDB_CHECK(!filter.allows("/sdk/./include/windows.h"));
+  TYPEDB_CHECK(filter.allows("/sdk/include/../src/a.h"));
+
+  PathFilter dotted({}, {"/sdk/x/../include"});
+  TYPEDB_CHECK(!dotted.allows("/sdk/include/windows.h"));
+}
+
+// Case only folds where the file system usually does.
+void test_case() {
+  PathFilter filter({}, {"/src/Game"});
+  TYPEDB_CHECK(!filter.allows("/src/Game/player.h"));
+#ifdef _WIN32
+  TYPEDB_CHECK(!filter.allows("/src/game/player.h"));
+  TYPEDB_CHECK(!filter.allows("/SRC/GAME/player.h"));
+#else
+  TYPEDB_CHECK(filter.allows("/src/game/player.h"));
+  TYPEDB_CHECK(filter.allows("/SRC/GAME/player.h"));
+#endif
+}
+
+void test_relative_paths() {
+  llvm::SmallString<256> cwd;
+  if (llvm::sys::fs::current_path(cwd)) {
+    return;
+  }
+  PathFilter filter({}, {"third_party"});
+  TYPEDB_CHECK(!filter.allows(std::string(cwd) + "/third_party/lib.h"));
+  TYPEDB_CHECK(!filter.allows("third_party/lib.h"));
+  TYPEDB_CHECK(!filter.allows("src/../third_party/lib.h"));
+  TYPEDB_CHECK(filter.allows("src/lib.h"));
+}
+
+void test_allow_and_deny() {
+  PathFilter empty;
+  TYPEDB_CHECK(empty.empty());
+  TYPEDB_CHECK(empty.allows("/anything.h"));
+
+  PathFilter filter({"/game"}, {"/game/generated"});
+  TYPEDB_CHECK(!filter.empty());
+  TYPEDB_CHECK(filter.allows("/game/player.h"));
+  TYPEDB_CHECK(!filter.allows("/game/generated/tables.h"));
+  TYPEDB_CHECK(!filter.allows("/gamedata/x.h"));
+  TYPEDB_CHECK(!filter.allows("/usr/include/stdio.h"));
+}
+
+void test_normalize() {
+#ifdef _WIN32
+  TYPEDB_CHECK_EQ(PathFilter::normalize("/A/b/../C/"), std::string("/a/c"));
+#else
+  TYPEDB_CHECK_EQ(PathFilter::normalize("/A/b/../C/"), std::string("/A/C"));
+#endif
+  TYPEDB_CHECK_EQ(PathFilter::normalize("/"), std::string("/"));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_component_boundary();
+  test_dots();
+  test_case();
+  test_relative_paths();
+  test_allow_and_deny();
+  test_normalize();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,223 @@
+#include "typedb_pipeline.h"
+#include "typedb.h"
+#include "typedb_builder.h"
+#include "typedb_json.h"
+#include "typedb_ordered_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace me3::typedb {
+namespace {
+
+class TypeDbAstConsumer : public clang::ASTConsumer {
+public:
+  TypeDbAstConsumer(const BuildOptions &options,
+                    const TypeDbCallback &on_built)
+      : options_(&options), on_built_(&on_built) {}
+
+  void HandleTranslationUnit(clang::ASTContext &ctx) override {
+    (*on_built_)(build_type_db(ctx, *options_));
+  }
+
+private:
+  const BuildOptions *options_;
+  const TypeDbCallback *on_built_;
+};
+
+class CreateTypeDbAction : public clang::ASTFrontendAction {
+public:
+  CreateTypeDbAction(const BuildOptions &options,
+                     const TypeDbCallback &on_built, ParseMode mode)
+      : options_(&options), on_built_(&on_built), mode_(mode) {}
+
+  // build_type_db only looks at declarations, so in fast mode the parser may
+  // skip function bodies entirely. ClangTool already runs -fsyntax-only.
+  auto BeginInvocation(clang::CompilerInstance &CI) -> bool override {
+    if (mode_ == ParseMode::Fast) {
+      CI.getFrontendOpts().SkipFunctionBodies = true;
+    }
+    return true;
+  }
+
+  auto CreateASTConsumer(clang::CompilerInstance & /*CI*/,
+                         llvm::StringRef /*InFile*/)
+      -> std::unique_ptr<clang::ASTConsumer> override {
+    return std::make_unique<TypeDbAstConsumer>(*options_, *on_built_);
+  }
+
+private:
+  const BuildOptions *options_;
+  const TypeDbCallback *on_built_;
+  ParseMode mode_;
+};
+
+struct BuildResult {
+  int status = 0;
+  std::optional<TypeDb> db;
+};
+
+auto build_source(const clang::tooling::CompilationDatabase &compilations,
+                  const std::string &source, const BuildOptions &build_options,
+                  ParseMode mode) -> BuildResult {
+  BuildResult result;
+  TypeDbActionFactory factory(
+      build_options, [&](TypeDb &&type_db) { result.db = std::move(type_db); },
+      mode);
+  // Each tool gets its own physical filesystem so that switching to the
+  // compile command's directory does not race with other workers.
+  clang::tooling::ClangTool tool(
+      compilations, {source}, std::make_shared<clang::PCHContainerOperations>(),
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(
+          llvm::vfs::createPhysicalFileSystem().release()));
+  result.status = tool.run(&factory);
+  return result;
+}
+
+constexpr size_t kMaxReportedDifferences = 8;
+
+// Compares the serialized nodes of a fast and a full parse; reports the first
+// few differences to stderr and returns false when they do not match.
+auto validate_fast_parse(const std::string &source, const TypeDb &fast,
+                         const TypeDb &full) -> bool {
+  size_t differences = 0;
+  std::string report;
+  auto note = [&](llvm::StringRef what, llvm::StringRef name) {
+    if (differences++ < kMaxReportedDifferences) {
+      report += ("  " + what + ": " + name + "\n").str();
+    }
+  };
+  for (const Node &node : full.nodes) {
+    auto fast_it = fast.node_index.find(node.name);
+    if (fast_it == fast.node_index.end()) {
+      note("missing from fast parse", node.name);
+    } else if (llvm::json::Value(node_to_json(node)) !=
+               llvm::json::Value(node_to_json(fast.nodes[fast_it->second]))) {
+      note("differs in fast parse", node.name);
+    }
+  }
+  for (const Node &node : fast.nodes) {
+    if (!full.node_index.contains(node.name)) {
+      note("only in fast parse", node.name);
+    }
+  }
+  if (differences == 0) {
+    return true;
+  }
+  llvm::errs() << source << ": fast parse differs from full parse in "
+               << differences << " node(s)\n"
+               << report;
+  return false;
+}
+
+} // namespace
+
+TypeDbActionFactory::TypeDbActionFactory(BuildOptions options,
+                                         TypeDbCallback on_built,
+                                         ParseMode mode)
+    : options_(std::move(options)), on_built_(std::move(on_built)),
+      mode_(mode) {}
+
+auto TypeDbActionFactory::create() -> std::unique_ptr<clang::FrontendAction> {
+  return std::make_unique<CreateTypeDbAction>(options_, on_built_, mode_);
+}
+
+auto run_pipeline(const clang::tooling::CompilationDatabase &compilations,
+                  const std::vector<std::string> &sources,
+                  const BuildOptions &build_options,
+                  const PipelineOptions &options, const ParsedTypeDbSink &sink)
+    -> int {
+  std::atomic<size_t> next_source{0};
+  std::atomic<int> status{0};
+
+  const unsigned jobs = std::max(1U, options.parse_jobs);
+  // Each parser may finish one db ahead of the serializer without blocking,
+  // on top of the configured queue depth.
+  OrderedQueue<ParsedTypeDb> queue(jobs + options.queue_depth);
+  if (options.metrics != nullptr) {
+    options.metrics->start(sources, jobs, build_options.type_ids);
+  }
+
+  auto parse_worker = [&](unsigned worker) {
+    BuildOptions worker_options = build_options;
+    PipelineMetrics::WorkerSlot *slot = nullptr;
+    if (options.metrics != nullptr) {
+      slot = &options.metrics->worker(worker);
+      worker_options.counters = &slot->counters;
+    }
+    for (size_t index = next_source++; index < sources.size();
+         index = next_source++) {
+      if (slot != nullptr) {
+        slot->begin(index);
+      }
+      auto started = std::chrono::steady_clock::now();
+      BuildResult built = build_source(compilations, sources[index],
+                                       worker_options, options.parse_mode);
+      std::chrono::duration<double> parse_time =
+          std::chrono::steady_clock::now() - started;
+      int result = built.status;
+      if (options.validate_fast && options.parse_mode == ParseMode::Fast &&
+          built.db) {
+        // Counted like any other parse, so progress does not stall on it.
+        BuildResult full = build_source(compilations, sources[index],
+                                        worker_options, ParseMode::Full);
+        if (full.db &&
+            !validate_fast_parse(sources[index], *built.db, *full.db)) {
+          result = std::max(result, kValidationFailedStatus);
+        }
+      }
+      if (slot != nullptr) {
+        slot->end();
+        options.metrics->finish_tu();
+      }
+      int current = status.load();
+      while (result > current &&
+             !status.compare_exchange_weak(current, result)) {
+      }
+      // The AST is gone once the tool has run; only the TypeDb waits in the
+      // queue. Failed sources are pushed empty so later ones are not held
+      // back.
+      std::optional<ParsedTypeDb> parsed;
+      if (built.db) {
+        parsed = ParsedTypeDb{.source_index = index,
+                              .source = sources[index],
+                              .db = std::move(*built.db),
+                              .parse_seconds = parse_time.count()};
+      }
+      queue.push(index, std::move(parsed));
+    }
+  };
+
+  std::thread serializer([&] {
+    while (std::optional<ParsedTypeDb> parsed = queue.pop()) {
+      sink(std::move(*parsed));
+    }
+  });
+
+  std::vector<std::thread> parsers;
+  parsers.reserve(jobs);
+  for (unsigned i = 0; i < jobs; ++i) {
+    parsers.emplace_back(parse_worker, i);
+  }
+  for (std::thread &parser : parsers) {
+    parser.join();
+  }
+  queue.close();
+  serializer.join();
+  return status.load();
+}
+
+} // namespace me3::typedb
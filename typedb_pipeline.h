@@ -0,0 +1,80 @@
+#pragma once
+#include "typedb.h"
+#include "typedb_builder.h"
+#include "typedb_metrics.h"
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace me3::typedb {
+
+using TypeDbCallback = std::function<void(TypeDb &&)>;
+
+enum class ParseMode : uint8_t {
+  // Parse and analyze everything, including inline function bodies.
+  Full,
+  // Skip function bodies; only declarations reach Sema.
+  Fast,
+};
+
+// Frontend action factory that builds a TypeDb for every translation unit it
+// is run on and hands it to the callback.
+class TypeDbActionFactory : public clang::tooling::FrontendActionFactory {
+public:
+  TypeDbActionFactory(BuildOptions options, TypeDbCallback on_built,
+                      ParseMode mode = ParseMode::Full);
+
+  auto create() -> std::unique_ptr<clang::FrontendAction> override;
+
+private:
+  BuildOptions options_;
+  TypeDbCallback on_built_;
+  ParseMode mode_;
+};
+
+// run_pipeline's status when a fast parse differs from its validating full
+// parse. Beyond ClangTool::run's 0 (ok), 1 (error) and 2 (skipped files).
+inline constexpr int kValidationFailedStatus = 3;
+
+struct PipelineOptions {
+  // Number of parser threads, i.e. the maximum number of ASTs alive at once.
+  unsigned parse_jobs = 1;
+  // Finished TypeDbs that may wait for the serializer, beyond one per parser,
+  // before parsers block.
+  unsigned queue_depth = 1;
+  ParseMode parse_mode = ParseMode::Full;
+  // With ParseMode::Fast, also run a full parse of every source and report
+  // sources whose databases differ.
+  bool validate_fast = false;
+  // When set, per-worker progress is published here for a MetricsReporter.
+  PipelineMetrics *metrics = nullptr;
+};
+
+struct ParsedTypeDb {
+  size_t source_index = 0;
+  std::string source;
+  TypeDb db;
+  // Wall time spent parsing and building the db, excluding validation.
+  double parse_seconds = 0;
+};
+
+using ParsedTypeDbSink = std::function<void(ParsedTypeDb &&)>;
+
+// Parses `sources` on `parse_jobs` threads and feeds each finished TypeDb,
+// after its AST has been released, through a bounded queue to `sink`. The
+// sink runs on a single dedicated consumer thread, in source order whatever
+// order the parses finish in, so output depends only on `sources`.
+// Returns the worst ClangTool::run status across all sources.
+auto run_pipeline(const clang::tooling::CompilationDatabase &compilations,
+                  const std::vector<std::string> &sources,
+                  const BuildOptions &build_options,
+                  const PipelineOptions &options, const ParsedTypeDbSink &sink)
+    -> int;
+
+} // namespace me3::typedb
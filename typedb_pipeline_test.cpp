@@ -0,0 +1,160 @@
+#include "typedb.h"
+#include "typedb_api.h"
+#include "typedb_json.h"
+#include "typedb_metrics.h"
+#include "typedb_pipeline.h"
+#include "typedb_test.h"
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/raw_ostream.h>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace me3::typedb;
+
+namespace {
+
+// Holder's layout depends on Local, which is only declared inside the body
+// of make(). Its deduced return type keeps Sema from skipping that body.
+constexpr const char *kDeducedBody = R"cpp(
+inline auto make() {
+  struct Local {
+    double value;
+    char tag;
+  };
+  return Local{};
+}
+struct Holder {
+  int id;
+  decltype(make()) local;
+};
+)cpp";
+
+// Hidden only exists inside a body that fast mode skips.
+constexpr const char *kSkippedBody = R"cpp(
+inline int count() {
+  struct Hidden {
+    int a;
+    int b;
+  };
+  return sizeof(Hidden);
+}
+)cpp";
+
+auto build(llvm::StringRef code, ParseMode mode) -> std::optional<TypeDb> {
+  std::optional<TypeDb> built;
+  bool compiled = build_from_code(
+      code, "input.cpp", default_compile_args(ParseMode::Fast),
+      [&](TypeDb &&type_db) { built = std::move(type_db); }, {}, mode);
+  TYPEDB_CHECK(compiled);
+  TYPEDB_CHECK(built.has_value());
+  return built;
+}
+
+// Function-local records are named after their function, e.g.
+// "count()::Hidden"; only the tail is matched here.
+auto has_local_record(const TypeDb &db, llvm::StringRef name) -> bool {
+  for (const Node &node : db.nodes) {
+    if (llvm::StringRef(node.name).endswith(("::" + name).str())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto formatted(const TypeDb &db) -> std::string {
+  return llvm::formatv("{0:2}", typedb_to_json(db)).str();
+}
+
+auto temp_source(llvm::StringRef code) -> std::string {
+  llvm::SmallString<256> path;
+  int fd = -1;
+  if (llvm::sys::fs::createTemporaryFile("typedb_pipeline_test", "cpp", fd,
+                                         path)) {
+    return {};
+  }
+  llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+  out << code;
+  return std::string(path);
+}
+
+struct PipelineRun {
+  int status = 0;
+  size_t parsed = 0;
+  uint64_t records = 0;
+};
+
+auto run_fast(llvm::StringRef code, bool validate) -> PipelineRun {
+  std::string source = temp_source(code);
+  clang::tooling::FixedCompilationDatabase compilations(
+      ".", default_compile_args(ParseMode::Fast));
+  PipelineMetrics metrics;
+  PipelineOptions options;
+  options.parse_mode = ParseMode::Fast;
+  options.validate_fast = validate;
+  options.metrics = &metrics;
+  PipelineRun run;
+  run.status = run_pipeline(compilations, {source}, {}, options,
+                            [&](ParsedTypeDb && /*parsed*/) { ++run.parsed; });
+  run.records = metrics.snapshot().records;
+  llvm::sys::fs::remove(source);
+  return run;
+}
+
+void test_fast_matches_full() {
+  std::optional<TypeDb> fast = build(kDeducedBody, ParseMode::Fast);
+  std::optional<TypeDb> full = build(kDeducedBody, ParseMode::Full);
+  if (!fast || !full) {
+    return;
+  }
+  TYPEDB_CHECK_EQ(formatted(*fast), formatted(*full));
+  auto holder = fast->node_index.find("Holder");
+  TYPEDB_CHECK(holder != fast->node_index.end());
+  if (holder != fast->node_index.end()) {
+    const auto *record =
+        std::get_if<ObjectType>(&fast->nodes[holder->second].data);
+    TYPEDB_CHECK(record != nullptr);
+    if (record != nullptr) {
+      TYPEDB_CHECK_EQ(record->size_bytes, uint64_t{24});
+      TYPEDB_CHECK_EQ(record->fields.size(), size_t{2});
+    }
+  }
+}
+
+void test_fast_skips_bodies() {
+  std::optional<TypeDb> fast = build(kSkippedBody, ParseMode::Fast);
+  std::optional<TypeDb> full = build(kSkippedBody, ParseMode::Full);
+  if (!fast || !full) {
+    return;
+  }
+  TYPEDB_CHECK(has_local_record(*full, "Hidden"));
+  TYPEDB_CHECK(!has_local_record(*fast, "Hidden"));
+}
+
+void test_validation_status() {
+  PipelineRun matching = run_fast(kDeducedBody, true);
+  TYPEDB_CHECK_EQ(matching.status, 0);
+  TYPEDB_CHECK_EQ(matching.parsed, size_t{1});
+
+  PipelineRun differing = run_fast(kSkippedBody, true);
+  TYPEDB_CHECK_EQ(differing.status, kValidationFailedStatus);
+  TYPEDB_CHECK_EQ(differing.parsed, size_t{1});
+
+  // The validating full parse reports to the same worker counters.
+  PipelineRun unvalidated = run_fast(kDeducedBody, false);
+  TYPEDB_CHECK(unvalidated.records != 0);
+  TYPEDB_CHECK_EQ(matching.records, 2 * unvalidated.records);
+}
+
+} // namespace
+
+auto main() -> int {
+  test_fast_matches_full();
+  test_fast_skips_bodies();
+  test_validation_status();
+  return me3::typedb::test::test_result();
+}
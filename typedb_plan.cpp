@@ -0,0 +1,184 @@
+#include "typedb_plan.h"
+#include <algorithm>
+#include <functional>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Errc.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <utility>
+
+namespace me3::typedb {
+namespace {
+
+constexpr unsigned kDecimalBase = 10;
+constexpr unsigned kPathBufferSize = 128;
+
+auto read_lines(llvm::StringRef path)
+    -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFileOrSTDIN(path, /*IsText=*/true);
+  if (!buffer) {
+    return llvm::createFileError(path, buffer.getError());
+  }
+  return std::move(*buffer);
+}
+
+template <typename Fn> void for_each_line(llvm::StringRef text, Fn &&fn) {
+  while (!text.empty()) {
+    auto [line, rest] = text.split('\n');
+    text = rest;
+    line = line.trim();
+    if (!line.empty() && line.front() != '#') {
+      fn(line);
+    }
+  }
+}
+
+} // namespace
+
+auto read_source_list(llvm::StringRef path)
+    -> llvm::Expected<std::vector<std::string>> {
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      read_lines(path);
+  if (!buffer) {
+    return buffer.takeError();
+  }
+  std::vector<std::string> sources;
+  for_each_line((*buffer)->getBuffer(),
+                [&](llvm::StringRef line) { sources.push_back(line.str()); });
+  return sources;
+}
+
+void write_timings(llvm::raw_ostream &out, const SourceTimings &timings) {
+  std::vector<std::pair<std::string, double>> sorted(timings.begin(),
+                                                     timings.end());
+  std::sort(sorted.begin(), sorted.end());
+  for (const auto &[source, seconds] : sorted) {
+    out << llvm::format("%.3f", seconds) << '\t' << source << '\n';
+  }
+}
+
+auto read_timings(llvm::StringRef path, SourceTimings &timings)
+    -> llvm::Error {
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      read_lines(path);
+  if (!buffer) {
+    return buffer.takeError();
+  }
+  std::optional<std::string> malformed;
+  for_each_line((*buffer)->getBuffer(), [&](llvm::StringRef line) {
+    auto [seconds_text, source] = line.split('\t');
+    double seconds = 0;
+    if (source.empty() || seconds_text.getAsDouble(seconds)) {
+      malformed = malformed.value_or(line.str());
+      return;
+    }
+    timings[source.str()] = seconds;
+  });
+  if (malformed) {
+    return llvm::createFileError(
+        path, llvm::createStringError(llvm::errc::invalid_argument,
+                                      "malformed timing line: %s",
+                                      malformed->c_str()));
+  }
+  return llvm::Error::success();
+}
+
+auto estimate_costs(const std::vector<std::string> &sources,
+                    const SourceTimings &timings) -> std::vector<double> {
+  std::vector<double> sizes(sources.size(), 0);
+  double timed_seconds = 0;
+  double timed_bytes = 0;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    uint64_t size = 0;
+    if (!llvm::sys::fs::file_size(sources[i], size)) {
+      sizes[i] = static_cast<double>(size);
+    }
+    if (auto timing = timings.find(sources[i]); timing != timings.end()) {
+      timed_seconds += timing->second;
+      timed_bytes += sizes[i];
+    }
+  }
+  double seconds_per_byte =
+      timed_bytes > 0 && timed_seconds > 0 ? timed_seconds / timed_bytes : 1;
+
+  std::vector<double> costs(sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    auto timing = timings.find(sources[i]);
+    costs[i] = timing != timings.end() ? timing->second
+                                       : sizes[i] * seconds_per_byte;
+  }
+  return costs;
+}
+
+auto plan_shards(const std::vector<std::string> &sources,
+                 const std::vector<double> &costs, unsigned shard_count)
+    -> std::vector<Shard> {
+  std::vector<Shard> shards(std::max(1U, shard_count));
+  std::vector<size_t> order(sources.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return costs[lhs] > costs[rhs];
+  });
+
+  // Least loaded shard first; ties go to the lower index so the plan is
+  // deterministic.
+  using Load = std::pair<double, size_t>;
+  std::priority_queue<Load, std::vector<Load>, std::greater<>> loads;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    loads.emplace(0, i);
+  }
+  for (size_t source : order) {
+    auto [load, shard] = loads.top();
+    loads.pop();
+    shards[shard].sources.push_back(sources[source]);
+    shards[shard].cost = load + costs[source];
+    loads.emplace(shards[shard].cost, shard);
+  }
+  return shards;
+}
+
+auto shard_manifest_path(llvm::StringRef dir, unsigned index, unsigned count)
+    -> std::string {
+  llvm::SmallString<kPathBufferSize> path(dir);
+  llvm::sys::path::append(path, "shard-" + std::to_string(index) + "-of-" +
+                                    std::to_string(count) + ".txt");
+  return std::string(path.str());
+}
+
+auto write_shard_manifest(llvm::StringRef path, const Shard &shard)
+    -> llvm::Error {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::OF_Text);
+  if (error) {
+    return llvm::createFileError(path, error);
+  }
+  out << "# estimated cost: " << llvm::format("%.3f", shard.cost) << '\n';
+  for (const std::string &source : shard.sources) {
+    out << source << '\n';
+  }
+  out.close();
+  if (out.has_error()) {
+    std::error_code write_error = out.error();
+    out.clear_error();
+    return llvm::createFileError(path, write_error);
+  }
+  return llvm::Error::success();
+}
+
+auto parse_shard_spec(llvm::StringRef spec, unsigned &index, unsigned &count)
+    -> bool {
+  auto [index_text, count_text] = spec.split('/');
+  if (index_text.getAsInteger(kDecimalBase, index) ||
+      count_text.getAsInteger(kDecimalBase, count)) {
+    return false;
+  }
+  return index >= 1 && index <= count;
+}
+
+} // namespace me3::typedb
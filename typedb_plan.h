@@ -0,0 +1,55 @@
+#pragma once
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace me3::typedb {
+
+// Per-source parse time in seconds, as written by write_timings.
+using SourceTimings = std::unordered_map<std::string, double>;
+
+struct Shard {
+  std::vector<std::string> sources;
+  // Sum of the estimated costs of `sources`.
+  double cost = 0;
+};
+
+// Reads a list of source paths, one per line. Blank lines and lines starting
+// with '#' are ignored. Used for --sources-from and shard manifests.
+auto read_source_list(llvm::StringRef path)
+    -> llvm::Expected<std::vector<std::string>>;
+
+// Writes "<seconds>\t<source>" lines.
+void write_timings(llvm::raw_ostream &out, const SourceTimings &timings);
+
+// Adds the timings in `path` to `timings`; later files win.
+auto read_timings(llvm::StringRef path, SourceTimings &timings) -> llvm::Error;
+
+// Estimated cost of each source. Sources with a recorded timing use it;
+// the others are priced by file size, scaled by the seconds-per-byte of the
+// timed sources when there are any.
+auto estimate_costs(const std::vector<std::string> &sources,
+                    const SourceTimings &timings) -> std::vector<double>;
+
+// Splits sources into `shard_count` shards of similar total cost using
+// longest-processing-time-first assignment. Each shard lists its sources
+// most expensive first.
+auto plan_shards(const std::vector<std::string> &sources,
+                 const std::vector<double> &costs, unsigned shard_count)
+    -> std::vector<Shard>;
+
+// Manifest file of shard `index` (1-based) out of `count` inside `dir`.
+auto shard_manifest_path(llvm::StringRef dir, unsigned index, unsigned count)
+    -> std::string;
+
+auto write_shard_manifest(llvm::StringRef path, const Shard &shard)
+    -> llvm::Error;
+
+// Parses "i/N" with 1 <= i <= N.
+auto parse_shard_spec(llvm::StringRef spec, unsigned &index, unsigned &count)
+    -> bool;
+
+} // namespace me3::typedb
@@ -0,0 +1,157 @@
+#include "typedb_plan.h"
+#include "typedb_test.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <vector>
+
+using namespace me3::typedb;
+
+namespace {
+
+auto temp_file(llvm::StringRef contents) -> std::string {
+  llvm::SmallString<256> path;
+  int fd = -1;
+  if (llvm::sys::fs::createTemporaryFile("typedb_plan_test", "txt", fd,
+                                         path)) {
+    return {};
+  }
+  llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+  out << contents;
+  return std::string(path);
+}
+
+auto joined(const std::vector<std::string> &values) -> std::string {
+  std::string text;
+  for (const std::string &value : values) {
+    text += value + " ";
+  }
+  return text;
+}
+
+void test_lpt() {
+  std::vector<Shard> shards =
+      plan_shards({"a", "b", "c", "d", "e", "f"}, {7, 5, 4, 3, 3, 2}, 2);
+  TYPEDB_CHECK_EQ(shards.size(), size_t{2});
+  TYPEDB_CHECK_EQ(joined(shards[0].sources), std::string("a d f "));
+  TYPEDB_CHECK_EQ(joined(shards[1].sources), std::string("b c e "));
+  TYPEDB_CHECK_EQ(shards[0].cost, 12.0);
+  TYPEDB_CHECK_EQ(shards[1].cost, 12.0);
+
+  // Equal costs keep source order and fill shards by index.
+  shards = plan_shards({"a", "b", "c", "d"}, {1, 1, 1, 1}, 3);
+  TYPEDB_CHECK_EQ(joined(shards[0].sources), std::string("a d "));
+  TYPEDB_CHECK_EQ(joined(shards[1].sources), std::string("b "));
+  TYPEDB_CHECK_EQ(joined(shards[2].sources), std::string("c "));
+
+  shards = plan_shards({"a"}, {1}, 3);
+  TYPEDB_CHECK_EQ(shards.size(), size_t{3});
+  TYPEDB_CHECK(shards[1].sources.empty() && shards[2].sources.empty());
+
+  shards = plan_shards({"a", "b"}, {1, 2}, 0);
+  TYPEDB_CHECK_EQ(shards.size(), size_t{1});
+  TYPEDB_CHECK_EQ(joined(shards[0].sources), std::string("b a "));
+}
+
+void test_estimate_costs() {
+  std::string small = temp_file(std::string(100, 'x'));
+  std::string large = temp_file(std::string(300, 'x'));
+  std::string missing = small + ".missing";
+
+  std::vector<double> costs = estimate_costs({small, large, missing}, {});
+  TYPEDB_CHECK_EQ(costs.at(0), 100.0);
+  TYPEDB_CHECK_EQ(costs.at(1), 300.0);
+  TYPEDB_CHECK_EQ(costs.at(2), 0.0);
+
+  // Untimed sources are priced at the timed ones' seconds per byte.
+  costs = estimate_costs({small, large}, {{small, 2.0}});
+  TYPEDB_CHECK_EQ(costs.at(0), 2.0);
+  TYPEDB_CHECK_EQ(costs.at(1), 6.0);
+
+  llvm::sys::fs::remove(small);
+  llvm::sys::fs::remove(large);
+}
+
+void test_timings_round_trip() {
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  write_timings(out, {{"b.cpp", 2.5}, {"a.cpp", 0.125}});
+  TYPEDB_CHECK_EQ(out.str(), std::string("0.125\ta.cpp\n2.500\tb.cpp\n"));
+
+  std::string path = temp_file(text + "# comment\n\n");
+  SourceTimings timings{{"a.cpp", 9.0}, {"c.cpp", 1.0}};
+  TYPEDB_CHECK(!llvm::errorToBool(read_timings(path, timings)));
+  TYPEDB_CHECK_EQ(timings.size(), size_t{3});
+  TYPEDB_CHECK_EQ(timings["a.cpp"], 0.125);
+  TYPEDB_CHECK_EQ(timings["b.cpp"], 2.5);
+  llvm::sys::fs::remove(path);
+
+  path = temp_file("1.0\ta.cpp\nnot-a-number\tb.cpp\n");
+  TYPEDB_CHECK(llvm::errorToBool(read_timings(path, timings)));
+  llvm::sys::fs::remove(path);
+  path = temp_file("1.0 a.cpp\n");
+  TYPEDB_CHECK(llvm::errorToBool(read_timings(path, timings)));
+  llvm::sys::fs::remove(path);
+}
+
+void test_manifests() {
+  TYPEDB_CHECK_EQ(shard_manifest_path("out", 2, 8),
+                  (llvm::Twine("out") +
+                   llvm::sys::path::get_separator() + "shard-2-of-8.txt")
+                      .str());
+
+  std::string path = temp_file("");
+  Shard shard{.sources = {"x.cpp", "dir/y.cpp"}, .cost = 1.5};
+  TYPEDB_CHECK(!llvm::errorToBool(write_shard_manifest(path, shard)));
+  llvm::Expected<std::vector<std::string>> read = read_source_list(path);
+  TYPEDB_CHECK(static_cast<bool>(read));
+  if (read) {
+    TYPEDB_CHECK_EQ(joined(*read), std::string("x.cpp dir/y.cpp "));
+  } else {
+    llvm::consumeError(read.takeError());
+  }
+  llvm::sys::fs::remove(path);
+
+  path = temp_file("  a.cpp  \n\n# skipped\nb.cpp\r\n");
+  read = read_source_list(path);
+  TYPEDB_CHECK(static_cast<bool>(read));
+  if (read) {
+    TYPEDB_CHECK_EQ(joined(*read), std::string("a.cpp b.cpp "));
+  } else {
+    llvm::consumeError(read.takeError());
+  }
+  llvm::sys::fs::remove(path);
+
+  read = read_source_list(path);
+  TYPEDB_CHECK(!read);
+  if (!read) {
+    llvm::consumeError(read.takeError());
+  }
+}
+
+void test_shard_spec() {
+  unsigned index = 0;
+  unsigned count = 0;
+  TYPEDB_CHECK(parse_shard_spec("3/8", index, count));
+  TYPEDB_CHECK_EQ(index, 3U);
+  TYPEDB_CHECK_EQ(count, 8U);
+  TYPEDB_CHECK(parse_shard_spec("1/1", index, count));
+  TYPEDB_CHECK(!parse_shard_spec("0/4", index, count));
+  TYPEDB_CHECK(!parse_shard_spec("5/4", index, count));
+  TYPEDB_CHECK(!parse_shard_spec("3", index, count));
+  TYPEDB_CHECK(!parse_shard_spec("a/b", index, count));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_lpt();
+  test_estimate_costs();
+  test_timings_round_trip();
+  test_manifests();
+  test_shard_spec();
+  return me3::typedb::test::test_result();
+}
@@ -0,0 +1,1559 @@
+// Python extension over the binary TypeDb written by --emit-binary. The file
+// is memory-mapped and read in place: Node, Field and Enumerator objects are
+// small views (database, index) created only when a caller asks for them, and
+// every attribute is decoded from the mapping on access.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "typedb_binary_format.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+namespace bin = me3::typedb::binary;
+
+static_assert(std::endian::native == std::endian::little,
+              "the binary type db is read in place and is little-endian");
+
+// Names as they appear in the serialized "kind" attribute, in bin::Kind
+// order.
+constexpr const char *kKindNames[] = {"builtin",
+                                      "template_param",
+                                      "pointer",
+                                      "const_array",
+                                      "incomplete_array",
+                                      "function",
+                                      "template_specialization",
+                                      "object",
+                                      "enum",
+                                      "vftable",
+                                      "unknown"};
+constexpr size_t kKindCount = std::size(kKindNames);
+static_assert(kKindCount == static_cast<size_t>(bin::Kind::Unknown) + 1);
+
+// validate() rejects kinds of kKindCount and above, so the shift is defined.
+constexpr auto kind_bit(bin::Kind kind) -> uint32_t {
+  return 1U << static_cast<uint32_t>(kind);
+}
+
+// Kinds whose size_bytes and align_bytes are byte counts.
+constexpr uint32_t kSizedKinds = kind_bit(bin::Kind::Object) |
+                                 kind_bit(bin::Kind::Enum) |
+                                 kind_bit(bin::Kind::VfTable);
+
+PyTypeObject *database_type = nullptr;
+PyTypeObject *node_type = nullptr;
+PyTypeObject *field_type = nullptr;
+PyTypeObject *enumerator_type = nullptr;
+PyTypeObject *node_list_type = nullptr;
+
+struct Mapping {
+  const char *data = nullptr;
+  size_t size = 0;
+};
+
+// Sets a Python exception and returns false on failure.
+auto map_file(PyObject *path, Mapping &mapping) -> bool {
+#ifdef _WIN32
+  PyObject *decoded = nullptr;
+  if (PyUnicode_FSDecoder(path, &decoded) == 0) {
+    return false;
+  }
+  wchar_t *wide = PyUnicode_AsWideCharString(decoded, nullptr);
+  if (wide == nullptr) {
+    Py_DECREF(decoded);
+    return false;
+  }
+  HANDLE file = CreateFileW(wide, GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  PyMem_Free(wide);
+  LARGE_INTEGER size{};
+  HANDLE section = nullptr;
+  void *view = nullptr;
+  if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) &&
+      size.QuadPart != 0) {
+    section = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  if (section != nullptr) {
+    view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+  }
+  // The view keeps the file open.
+  DWORD error = GetLastError();
+  if (section != nullptr) {
+    CloseHandle(section);
+  }
+  if (file != INVALID_HANDLE_VALUE) {
+    CloseHandle(file);
+  }
+  if (view == nullptr) {
+    if (size.QuadPart == 0 && file != INVALID_HANDLE_VALUE) {
+      PyErr_Format(PyExc_ValueError, "%R is empty", decoded);
+    } else {
+      PyErr_SetExcFromWindowsErrWithFilenameObject(PyExc_OSError, error,
+                                                   decoded);
+    }
+    Py_DECREF(decoded);
+    return false;
+  }
+  Py_DECREF(decoded);
+  mapping.data = static_cast<const char *>(view);
+  mapping.size = static_cast<size_t>(size.QuadPart);
+  return true;
+#else
+  PyObject *encoded = nullptr;
+  if (PyUnicode_FSConverter(path, &encoded) == 0) {
+    return false;
+  }
+  int fd = ::open(PyBytes_AS_STRING(encoded), O_RDONLY | O_CLOEXEC);
+  struct stat info {};
+  void *view = MAP_FAILED;
+  if (fd >= 0 && ::fstat(fd, &info) == 0 && info.st_size != 0) {
+    view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                  MAP_SHARED, fd, 0);
+  }
+  int error = errno;
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  if (view == MAP_FAILED) {
+    if (fd >= 0 && info.st_size == 0) {
+      PyErr_Format(PyExc_ValueError, "%R is empty", path);
+    } else {
+      errno = error;
+      PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+    }
+    Py_DECREF(encoded);
+    return false;
+  }
+  Py_DECREF(encoded);
+  mapping.data = static_cast<const char *>(view);
+  mapping.size = static_cast<size_t>(info.st_size);
+  return true;
+#endif
+}
+
+void unmap_file(Mapping &mapping) {
+  if (mapping.data == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(mapping.data);
+#else
+  ::munmap(const_cast<char *>(mapping.data), mapping.size);
+#endif
+  mapping = Mapping{};
+}
+
+struct DatabaseObject {
+  PyObject_HEAD
+  Mapping mapping;
+  // Buffers handed out over the mapping; close() refuses while any exist.
+  Py_ssize_t exports;
+};
+
+struct NodeObject {
+  PyObject_HEAD
+  DatabaseObject *db;
+  uint32_t index;
+};
+
+struct FieldObject {
+  PyObject_HEAD
+  DatabaseObject *db;
+  uint32_t index;
+};
+
+struct EnumeratorObject {
+  PyObject_HEAD
+  DatabaseObject *db;
+  uint32_t index;
+  // The enum node, whose flags decide how the value is read.
+  uint32_t node;
+};
+
+struct NodeListObject {
+  PyObject_HEAD
+  DatabaseObject *db;
+  std::vector<uint32_t> *indices;
+  // Shape of exported buffers: the number of indices.
+  Py_ssize_t length;
+};
+
+auto header(const DatabaseObject *db) -> const bin::Header & {
+  return *reinterpret_cast<const bin::Header *>(db->mapping.data);
+}
+
+template <typename T>
+auto table(const DatabaseObject *db, const bin::Section &section)
+    -> const T * {
+  return reinterpret_cast<const T *>(db->mapping.data + section.offset);
+}
+
+auto check_open(const DatabaseObject *db) -> bool {
+  if (db->mapping.data == nullptr) {
+    PyErr_SetString(PyExc_ValueError, "operation on a closed type db");
+    return false;
+  }
+  return true;
+}
+
+auto node_count(const DatabaseObject *db) -> uint32_t {
+  return static_cast<uint32_t>(header(db).nodes.count);
+}
+
+auto node_at(const DatabaseObject *db, uint32_t index) -> const bin::Node & {
+  return table<bin::Node>(db, header(db).nodes)[index];
+}
+
+auto field_at(const DatabaseObject *db, uint32_t index) -> const bin::Field & {
+  return table<bin::Field>(db, header(db).fields)[index];
+}
+
+auto enumerator_at(const DatabaseObject *db, uint32_t index)
+    -> const bin::Enumerator & {
+  return table<bin::Enumerator>(db, header(db).enumerators)[index];
+}
+
+// Bounds are checked on use, so a corrupt file raises instead of reading
+// outside the mapping.
+auto checked_range(uint64_t first, uint64_t count, const bin::Section &section)
+    -> bool {
+  if (first > section.count || count > section.count - first) {
+    PyErr_SetString(PyExc_ValueError, "type db entry is out of range");
+    return false;
+  }
+  return true;
+}
+
+auto text(const DatabaseObject *db, bin::StringRef ref, std::string_view &out)
+    -> bool {
+  const bin::Header &head = header(db);
+  if (!checked_range(ref.offset, ref.size, head.strings)) {
+    return false;
+  }
+  out = std::string_view(table<char>(db, head.strings) + ref.offset,
+                         ref.size);
+  return true;
+}
+
+auto new_str(const DatabaseObject *db, bin::StringRef ref) -> PyObject * {
+  std::string_view value;
+  if (!text(db, ref, value)) {
+    return nullptr;
+  }
+  return PyUnicode_DecodeUTF8(value.data(),
+                              static_cast<Py_ssize_t>(value.size()),
+                              "surrogateescape");
+}
+
+// Encodes a str argument for comparison against the mapping.
+auto utf8(PyObject *value, std::string_view &out) -> bool {
+  if (!PyUnicode_Check(value)) {
+    PyErr_Format(PyExc_TypeError, "expected str, not %.200s",
+                 Py_TYPE(value)->tp_name);
+    return false;
+  }
+  Py_ssize_t size = 0;
+  const char *data = PyUnicode_AsUTF8AndSize(value, &size);
+  if (data == nullptr) {
+    return false;
+  }
+  out = std::string_view(data, static_cast<size_t>(size));
+  return true;
+}
+
+auto parse_kind(PyObject *value, bin::Kind &kind) -> bool {
+  std::string_view name;
+  if (!utf8(value, name)) {
+    return false;
+  }
+  for (size_t i = 0; i < kKindCount; ++i) {
+    if (name == kKindNames[i]) {
+      kind = static_cast<bin::Kind>(i);
+      return true;
+    }
+  }
+  PyErr_Format(PyExc_ValueError, "unknown node kind %R", value);
+  return false;
+}
+
+auto new_node(DatabaseObject *db, uint32_t index) -> PyObject * {
+  NodeObject *node = PyObject_New(NodeObject, node_type);
+  if (node == nullptr) {
+    return nullptr;
+  }
+  Py_INCREF(db);
+  node->db = db;
+  node->index = index;
+  return reinterpret_cast<PyObject *>(node);
+}
+
+auto new_field(DatabaseObject *db, uint32_t index) -> PyObject * {
+  FieldObject *field = PyObject_New(FieldObject, field_type);
+  if (field == nullptr) {
+    return nullptr;
+  }
+  Py_INCREF(db);
+  field->db = db;
+  field->index = index;
+  return reinterpret_cast<PyObject *>(field);
+}
+
+auto new_enumerator(DatabaseObject *db, uint32_t index, uint32_t node)
+    -> PyObject * {
+  EnumeratorObject *enumerator =
+      PyObject_New(EnumeratorObject, enumerator_type);
+  if (enumerator == nullptr) {
+    return nullptr;
+  }
+  Py_INCREF(db);
+  enumerator->db = db;
+  enumerator->index = index;
+  enumerator->node = node;
+  return reinterpret_cast<PyObject *>(enumerator);
+}
+
+auto new_node_list(DatabaseObject *db, std::vector<uint32_t> &&indices)
+    -> PyObject * {
+  NodeListObject *list = PyObject_New(NodeListObject, node_list_type);
+  if (list == nullptr) {
+    return nullptr;
+  }
+  list->indices = new (std::nothrow) std::vector<uint32_t>(std::move(indices));
+  if (list->indices == nullptr) {
+    list->db = nullptr;
+    Py_DECREF(list);
+    return PyErr_NoMemory();
+  }
+  Py_INCREF(db);
+  list->db = db;
+  list->length = static_cast<Py_ssize_t>(list->indices->size());
+  return reinterpret_cast<PyObject *>(list);
+}
+
+// Index of the node named `name`, found by binary search over name_index.
+auto find_node(const DatabaseObject *db, std::string_view name,
+               uint32_t &index) -> bool {
+  const bin::Header &head = header(db);
+  const uint32_t *order = table<uint32_t>(db, head.name_index);
+  const char *strings = table<char>(db, head.strings);
+  auto name_of = [&](uint32_t node) {
+    if (node >= head.nodes.count) {
+      return std::string_view();
+    }
+    const bin::StringRef &ref = node_at(db, node).name;
+    if (ref.offset > head.strings.count ||
+        ref.size > head.strings.count - ref.offset) {
+      return std::string_view();
+    }
+    return std::string_view(strings + ref.offset, ref.size);
+  };
+  const uint32_t *end = order + head.name_index.count;
+  const uint32_t *it =
+      std::lower_bound(order, end, name, [&](uint32_t node, auto wanted) {
+        return name_of(node) < wanted;
+      });
+  if (it == end || name_of(*it) != name) {
+    return false;
+  }
+  index = *it;
+  return true;
+}
+
+// Checks that every table lies within the mapping and that every node kind
+// is known, so accessors can index by kind without checking again.
+auto validate(DatabaseObject *db, PyObject *path) -> bool {
+  const Mapping &mapping = db->mapping;
+  if (mapping.size < sizeof(bin::Header) ||
+      std::memcmp(mapping.data, bin::kMagic, sizeof(bin::kMagic)) != 0) {
+    PyErr_Format(PyExc_ValueError, "%R is not a binary type db", path);
+    return false;
+  }
+  const bin::Header &head = header(db);
+  if (head.version != bin::kVersion) {
+    PyErr_Format(PyExc_ValueError,
+                 "%R has binary type db version %u, expected %u", path,
+                 head.version, bin::kVersion);
+    return false;
+  }
+  struct {
+    const bin::Section *section;
+    size_t width;
+  } const sections[] = {
+      {&head.strings, 1},
+      {&head.nodes, sizeof(bin::Node)},
+      {&head.fields, sizeof(bin::Field)},
+      {&head.enumerators, sizeof(bin::Enumerator)},
+      {&head.string_lists, sizeof(bin::StringRef)},
+      {&head.indices, sizeof(uint32_t)},
+      {&head.name_index, sizeof(uint32_t)},
+  };
+  for (const auto &entry : sections) {
+    const bin::Section &section = *entry.section;
+    if (section.offset % alignof(uint64_t) != 0 ||
+        section.offset > mapping.size ||
+        section.count > (mapping.size - section.offset) / entry.width) {
+      PyErr_Format(PyExc_ValueError, "%R is truncated or corrupt", path);
+      return false;
+    }
+  }
+  if (head.nodes.count > UINT32_MAX ||
+      head.name_index.count != head.nodes.count) {
+    PyErr_Format(PyExc_ValueError, "%R is truncated or corrupt", path);
+    return false;
+  }
+  const bin::Node *nodes = table<bin::Node>(db, head.nodes);
+  for (uint64_t i = 0; i < head.nodes.count; ++i) {
+    if (static_cast<size_t>(nodes[i].kind) >= kKindCount) {
+      PyErr_Format(PyExc_ValueError, "%R has a node of unknown kind %u", path,
+                   static_cast<unsigned>(nodes[i].kind));
+      return false;
+    }
+  }
+  return true;
+}
+
+auto database_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+    -> PyObject * {
+  static const char *keywords[] = {"path", nullptr};
+  PyObject *path = nullptr;
+  if (PyArg_ParseTupleAndKeywords(args, kwargs, "O:Database",
+                                  const_cast<char **>(keywords),
+                                  &path) == 0) {
+    return nullptr;
+  }
+  auto *db = reinterpret_cast<DatabaseObject *>(type->tp_alloc(type, 0));
+  if (db == nullptr) {
+    return nullptr;
+  }
+  db->mapping = Mapping{};
+  db->exports = 0;
+  if (!map_file(path, db->mapping) || !validate(db, path)) {
+    Py_DECREF(db);
+    return nullptr;
+  }
+  return reinterpret_cast<PyObject *>(db);
+}
+
+void database_dealloc(DatabaseObject *db) {
+  unmap_file(db->mapping);
+  PyTypeObject *type = Py_TYPE(db);
+  type->tp_free(db);
+  Py_DECREF(type);
+}
+
+auto database_close(DatabaseObject *db, PyObject * /*unused*/) -> PyObject * {
+  if (db->exports > 0) {
+    PyErr_SetString(PyExc_BufferError,
+                    "cannot close a type db with exported buffers");
+    return nullptr;
+  }
+  unmap_file(db->mapping);
+  Py_RETURN_NONE;
+}
+
+auto database_enter(DatabaseObject *db, PyObject * /*unused*/) -> PyObject * {
+  if (!check_open(db)) {
+    return nullptr;
+  }
+  Py_INCREF(db);
+  return reinterpret_cast<PyObject *>(db);
+}
+
+auto database_exit(DatabaseObject *db, PyObject * /*args*/) -> PyObject * {
+  return database_close(db, nullptr);
+}
+
+auto database_length(DatabaseObject *db) -> Py_ssize_t {
+  if (!check_open(db)) {
+    return -1;
+  }
+  return static_cast<Py_ssize_t>(node_count(db));
+}
+
+auto database_item(DatabaseObject *db, Py_ssize_t index) -> PyObject * {
+  if (!check_open(db)) {
+    return nullptr;
+  }
+  if (index < 0 || index >= static_cast<Py_ssize_t>(node_count(db))) {
+    PyErr_SetString(PyExc_IndexError, "node index out of range");
+    return nullptr;
+  }
+  return new_node(db, static_cast<uint32_t>(index));
+}
+
+auto database_subscript(DatabaseObject *db, PyObject *key) -> PyObject * {
+  if (!check_open(db)) {
+    return nullptr;
+  }
+  if (PyUnicode_Check(key)) {
+    std::string_view name;
+    uint32_t index = 0;
+    if (!utf8(key, name)) {
+      return nullptr;
+    }
+    if (!find_node(db, name, index)) {
+      PyErr_SetObject(PyExc_KeyError, key);
+      return nullptr;
+    }
+    return new_node(db, index);
+  }
+  Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+  if (index == -1 && PyErr_Occurred() != nullptr) {
+    return nullptr;
+  }
+  if (index < 0) {
+    index += static_cast<Py_ssize_t>(node_count(db));
+  }
+  return database_item(db, index);
+}
+
+auto database_contains(DatabaseObject *db, PyObject *key) -> int {
+  std::string_view name;
+  uint32_t index = 0;
+  if (!check_open(db) || !utf8(key, name)) {
+    return -1;
+  }
+  return find_node(db, name, index) ? 1 : 0;
+}
+
+auto database_find(DatabaseObject *db, PyObject *name) -> PyObject * {
+  std::string_view wanted;
+  uint32_t index = 0;
+  if (!check_open(db) || !utf8(name, wanted)) {
+    return nullptr;
+  }
+  if (!find_node(db, wanted, index)) {
+    Py_RETURN_NONE;
+  }
+  return new_node(db, index);
+}
+
+// Filters the node table in one pass without creating any Python objects.
+// `kinds` is a mask of kind_bit values; size bounds only match kinds whose
+// size is a byte count.
+auto select_nodes(DatabaseObject *db, uint32_t kinds,
+                  std::optional<uint64_t> min_size,
+                  std::optional<uint64_t> max_size, std::string_view prefix)
+    -> PyObject * {
+  const bin::Header &head = header(db);
+  const bin::Node *nodes = table<bin::Node>(db, head.nodes);
+  const char *strings = table<char>(db, head.strings);
+  bool sized = min_size || max_size;
+  std::vector<uint32_t> matches;
+  for (uint32_t i = 0; i < head.nodes.count; ++i) {
+    const bin::Node &node = nodes[i];
+    uint32_t kind = kind_bit(node.kind);
+    if ((kinds & kind) == 0 || (sized && (kSizedKinds & kind) == 0) ||
+        (min_size && node.size_bytes < *min_size) ||
+        (max_size && node.size_bytes > *max_size)) {
+      continue;
+    }
+    if (!prefix.empty()) {
+      if (node.name.size < prefix.size() ||
+          node.name.offset > head.strings.count ||
+          node.name.size > head.strings.count - node.name.offset ||
+          std::memcmp(strings + node.name.offset, prefix.data(),
+                      prefix.size()) != 0) {
+        continue;
+      }
+    }
+    matches.push_back(i);
+  }
+  return new_node_list(db, std::move(matches));
+}
+
+auto optional_size(PyObject *value, std::optional<uint64_t> &out) -> bool {
+  if (value == nullptr || value == Py_None) {
+    return true;
+  }
+  unsigned long long size = PyLong_AsUnsignedLongLong(value);
+  if (size == static_cast<unsigned long long>(-1) &&
+      PyErr_Occurred() != nullptr) {
+    return false;
+  }
+  out = size;
+  return true;
+}
+
+auto database_select(DatabaseObject *db, PyObject *args, PyObject *kwargs)
+    -> PyObject * {
+  static const char *keywords[] = {"kind", "min_size", "max_size", "prefix",
+                                   nullptr};
+  PyObject *kind = Py_None;
+  PyObject *min_object = Py_None;
+  PyObject *max_object = Py_None;
+  PyObject *prefix_object = Py_None;
+  if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O$OOO:select",
+                                  const_cast<char **>(keywords), &kind,
+                                  &min_object, &max_object,
+                                  &prefix_object) == 0 ||
+      !check_open(db)) {
+    return nullptr;
+  }
+  uint32_t kinds = ~0U;
+  if (kind != Py_None) {
+    bin::Kind parsed{};
+    if (!parse_kind(kind, parsed)) {
+      return nullptr;
+    }
+    kinds = kind_bit(parsed);
+  }
+  std::optional<uint64_t> min_size;
+  std::optional<uint64_t> max_size;
+  std::string_view prefix;
+  if (!optional_size(min_object, min_size) ||
+      !optional_size(max_object, max_size) ||
+      (prefix_object != Py_None && !utf8(prefix_object, prefix))) {
+    return nullptr;
+  }
+  return select_nodes(db, kinds, min_size, max_size, prefix);
+}
+
+auto database_structs_larger_than(DatabaseObject *db, PyObject *size)
+    -> PyObject * {
+  unsigned long long bound = PyLong_AsUnsignedLongLong(size);
+  if ((bound == static_cast<unsigned long long>(-1) &&
+       PyErr_Occurred() != nullptr) ||
+      !check_open(db)) {
+    return nullptr;
+  }
+  if (bound == UINT64_MAX) {
+    return new_node_list(db, {});
+  }
+  return select_nodes(db, kind_bit(bin::Kind::Object), bound + 1,
+                      std::nullopt, {});
+}
+
+auto database_nodes_of_kind(DatabaseObject *db, PyObject *kind)
+    -> PyObject * {
+  bin::Kind parsed{};
+  if (!check_open(db) || !parse_kind(kind, parsed)) {
+    return nullptr;
+  }
+  return select_nodes(db, kind_bit(parsed), std::nullopt, std::nullopt, {});
+}
+
+auto database_section(DatabaseObject *db, PyObject *name) -> PyObject * {
+  std::string_view wanted;
+  if (!check_open(db) || !utf8(name, wanted)) {
+    return nullptr;
+  }
+  const bin::Header &head = header(db);
+  struct {
+    const char *name;
+    const bin::Section *section;
+    size_t width;
+  } const sections[] = {
+      {"strings", &head.strings, 1},
+      {"nodes", &head.nodes, sizeof(bin::Node)},
+      {"fields", &head.fields, sizeof(bin::Field)},
+      {"enumerators", &head.enumerators, sizeof(bin::Enumerator)},
+      {"string_lists", &head.string_lists, sizeof(bin::StringRef)},
+      {"indices", &head.indices, sizeof(uint32_t)},
+      {"name_index", &head.name_index, sizeof(uint32_t)},
+  };
+  for (const auto &entry : sections) {
+    if (wanted != entry.name) {
+      continue;
+    }
+    PyObject *whole = PyMemoryView_FromObject(reinterpret_cast<PyObject *>(db));
+    if (whole == nullptr) {
+      return nullptr;
+    }
+    auto start = static_cast<Py_ssize_t>(entry.section->offset);
+    auto stop = start + static_cast<Py_ssize_t>(entry.section->count *
+                                                entry.width);
+    PyObject *start_object = PyLong_FromSsize_t(start);
+    PyObject *stop_object = PyLong_FromSsize_t(stop);
+    PyObject *slice = start_object != nullptr && stop_object != nullptr
+                          ? PySlice_New(start_object, stop_object, nullptr)
+                          : nullptr;
+    Py_XDECREF(start_object);
+    Py_XDECREF(stop_object);
+    PyObject *view = slice != nullptr ? PyObject_GetItem(whole, slice)
+                                      : nullptr;
+    Py_XDECREF(slice);
+    Py_DECREF(whole);
+    return view;
+  }
+  PyErr_Format(PyExc_ValueError, "unknown section %R", name);
+  return nullptr;
+}
+
+auto database_getbuffer(DatabaseObject *db, Py_buffer *view, int flags)
+    -> int {
+  if (!check_open(db)) {
+    view->obj = nullptr;
+    return -1;
+  }
+  if (PyBuffer_FillInfo(view, reinterpret_cast<PyObject *>(db),
+                        const_cast<char *>(db->mapping.data),
+                        static_cast<Py_ssize_t>(db->mapping.size), 1,
+                        flags) != 0) {
+    return -1;
+  }
+  ++db->exports;
+  return 0;
+}
+
+void database_releasebuffer(DatabaseObject *db, Py_buffer * /*view*/) {
+  --db->exports;
+}
+
+auto database_triple(DatabaseObject *db, void * /*closure*/) -> PyObject * {
+  if (!check_open(db)) {
+    return nullptr;
+  }
+  return new_str(db, header(db).triple);
+}
+
+// Closure is the offset of an int32_t member of bin::Header.
+auto database_width(DatabaseObject *db, void *closure) -> PyObject * {
+  if (!check_open(db)) {
+    return nullptr;
+  }
+  int32_t value = 0;
+  std::memcpy(&value,
+              reinterpret_cast<const char *>(&header(db)) +
+                  reinterpret_cast<uintptr_t>(closure),
+              sizeof(value));
+  return PyLong_FromLong(value);
+}
+
+auto database_closed(DatabaseObject *db, void * /*closure*/) -> PyObject * {
+  return PyBool_FromLong(db->mapping.data == nullptr ? 1 : 0);
+}
+
+auto header_member(size_t offset) -> void * {
+  return reinterpret_cast<void *>(static_cast<uintptr_t>(offset));
+}
+
+PyMethodDef database_methods[] = {
+    {"find", reinterpret_cast<PyCFunction>(database_find), METH_O,
+     "find(name) -> Node | None\n\nLooks a node up by name."},
+    {"select",
+     reinterpret_cast<PyCFunction>(
+         reinterpret_cast<void (*)()>(database_select)),
+     METH_VARARGS | METH_KEYWORDS,
+     "select(kind=None, *, min_size=None, max_size=None, prefix=None)"
+     " -> NodeList\n\nNodes matching every given filter, found in one pass "
+     "over the node table. Size bounds are inclusive and only match "
+     "objects, enums and vftables."},
+    {"structs_larger_than",
+     reinterpret_cast<PyCFunction>(database_structs_larger_than), METH_O,
+     "structs_larger_than(size) -> NodeList\n\nObjects whose size_bytes is "
+     "greater than size."},
+    {"nodes_of_kind", reinterpret_cast<PyCFunction>(database_nodes_of_kind),
+     METH_O, "nodes_of_kind(kind) -> NodeList"},
+    {"section", reinterpret_cast<PyCFunction>(database_section), METH_O,
+     "section(name) -> memoryview\n\nRaw bytes of one table: strings, nodes, "
+     "fields, enumerators, string_lists, indices or name_index. Record "
+     "layouts are described in typedb_binary_format.h."},
+    {"close", reinterpret_cast<PyCFunction>(database_close), METH_NOARGS,
+     "Unmaps the file. Nodes and fields of a closed db raise ValueError."},
+    {"__enter__", reinterpret_cast<PyCFunction>(database_enter), METH_NOARGS,
+     nullptr},
+    {"__exit__", reinterpret_cast<PyCFunction>(database_exit), METH_VARARGS,
+     nullptr},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef database_getset[] = {
+    {"triple", reinterpret_cast<getter>(database_triple), nullptr, nullptr,
+     nullptr},
+    {"pointer_width_bits", reinterpret_cast<getter>(database_width), nullptr,
+     nullptr, header_member(offsetof(bin::Header, pointer_width_bits))},
+    {"char_width_bits", reinterpret_cast<getter>(database_width), nullptr,
+     nullptr, header_member(offsetof(bin::Header, char_width_bits))},
+    {"long_width_bits", reinterpret_cast<getter>(database_width), nullptr,
+     nullptr, header_member(offsetof(bin::Header, long_width_bits))},
+    {"closed", reinterpret_cast<getter>(database_closed), nullptr, nullptr,
+     nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot database_slots[] = {
+    {Py_tp_doc, const_cast<char *>(
+                    "Database(path)\n\nA memory-mapped binary type db. "
+                    "Indexing by int or str, iteration and `in` yield "
+                    "lazily created Node views. Supports the buffer "
+                    "protocol over the whole mapping.")},
+    {Py_tp_new, reinterpret_cast<void *>(database_new)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(database_dealloc)},
+    {Py_tp_methods, database_methods},
+    {Py_tp_getset, database_getset},
+    {Py_sq_length, reinterpret_cast<void *>(database_length)},
+    {Py_sq_item, reinterpret_cast<void *>(database_item)},
+    {Py_sq_contains, reinterpret_cast<void *>(database_contains)},
+    {Py_mp_length, reinterpret_cast<void *>(database_length)},
+    {Py_mp_subscript, reinterpret_cast<void *>(database_subscript)},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(database_getbuffer)},
+    {Py_bf_releasebuffer, reinterpret_cast<void *>(database_releasebuffer)},
+    {0, nullptr},
+};
+
+// Views are only created by a Database. Py_TPFLAGS_DISALLOW_INSTANTIATION
+// would say the same but needs Python 3.10.
+auto view_new(PyTypeObject *type, PyObject * /*args*/, PyObject * /*kwargs*/)
+    -> PyObject * {
+  PyErr_Format(PyExc_TypeError, "cannot create '%s' instances",
+               type->tp_name);
+  return nullptr;
+}
+
+void view_dealloc(PyObject *self) {
+  // Every view starts with the same PyObject_HEAD and db members.
+  Py_XDECREF(reinterpret_cast<NodeObject *>(self)->db);
+  PyTypeObject *type = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(type);
+}
+
+// Sets `node` to the viewed record, or raises if the db was closed.
+auto resolve(const NodeObject *self, const bin::Node *&node) -> bool {
+  if (!check_open(self->db)) {
+    return false;
+  }
+  node = &node_at(self->db, self->index);
+  return true;
+}
+
+auto node_index(NodeObject *self, void * /*closure*/) -> PyObject * {
+  return PyLong_FromUnsignedLong(self->index);
+}
+
+auto node_name(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  return resolve(self, node) ? new_str(self->db, node->name) : nullptr;
+}
+
+auto node_cdecl(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  return new_str(self->db, node->cdecl.size != 0 ? node->cdecl : node->name);
+}
+
+auto node_kind(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  return PyUnicode_FromString(kKindNames[static_cast<size_t>(node->kind)]);
+}
+
+auto closure_mask(void *closure) -> uint32_t {
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(closure));
+}
+
+auto mask_closure(uint32_t mask) -> void * {
+  return reinterpret_cast<void *>(static_cast<uintptr_t>(mask));
+}
+
+// Closure is the mask of kinds for which Node::text holds this attribute;
+// other kinds read as None.
+auto node_text(NodeObject *self, void *closure) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  uint32_t kind = kind_bit(node->kind);
+  if ((closure_mask(closure) & kind) == 0 ||
+      (node->kind == bin::Kind::Object &&
+       (node->flags & bin::kHasPrimaryTemplate) == 0)) {
+    Py_RETURN_NONE;
+  }
+  return new_str(self->db, node->text);
+}
+
+// Closure is a Node::flags bit.
+auto node_flag(NodeObject *self, void *closure) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  return PyBool_FromLong((node->flags & closure_mask(closure)) != 0 ? 1 : 0);
+}
+
+auto node_size_bytes(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if ((kSizedKinds & kind_bit(node->kind)) == 0) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(node->size_bytes);
+}
+
+auto node_align_bytes(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if ((kSizedKinds & kind_bit(node->kind)) == 0) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(node->align_bytes);
+}
+
+auto node_size(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::ConstArray) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(node->size_bytes);
+}
+
+auto node_param_index(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::TemplateParam) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromLong(node->template_index);
+}
+
+auto node_param_depth(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::TemplateParam) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromLong(node->template_depth);
+}
+
+auto new_string_tuple(DatabaseObject *db, uint32_t first, uint32_t count)
+    -> PyObject * {
+  const bin::Header &head = header(db);
+  if (!checked_range(first, count, head.string_lists)) {
+    return nullptr;
+  }
+  const bin::StringRef *refs = table<bin::StringRef>(db, head.string_lists);
+  PyObject *tuple = PyTuple_New(count);
+  for (uint32_t i = 0; tuple != nullptr && i < count; ++i) {
+    PyObject *value = new_str(db, refs[first + i]);
+    if (value == nullptr) {
+      Py_CLEAR(tuple);
+      break;
+    }
+    PyTuple_SET_ITEM(tuple, i, value);
+  }
+  return tuple;
+}
+
+// Closure is the mask of kinds whose children are string_lists entries.
+auto node_child_strings(NodeObject *self, void *closure) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if ((closure_mask(closure) & kind_bit(node->kind)) == 0) {
+    return PyTuple_New(0);
+  }
+  return new_string_tuple(self->db, node->first_child, node->child_count);
+}
+
+auto node_template_type_args(NodeObject *self, void * /*closure*/)
+    -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::Object) {
+    return PyTuple_New(0);
+  }
+  return new_string_tuple(self->db, node->first_extra, node->extra_count);
+}
+
+auto node_fields(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::Object && node->kind != bin::Kind::VfTable) {
+    return PyTuple_New(0);
+  }
+  if (!checked_range(node->first_child, node->child_count,
+                     header(self->db).fields)) {
+    return nullptr;
+  }
+  PyObject *tuple = PyTuple_New(node->child_count);
+  for (uint32_t i = 0; tuple != nullptr && i < node->child_count; ++i) {
+    PyObject *field = new_field(self->db, node->first_child + i);
+    if (field == nullptr) {
+      Py_CLEAR(tuple);
+      break;
+    }
+    PyTuple_SET_ITEM(tuple, i, field);
+  }
+  return tuple;
+}
+
+auto enum_value(const bin::Node &node, uint64_t value) -> PyObject * {
+  if ((node.flags & bin::kSigned) != 0) {
+    return PyLong_FromLongLong(static_cast<int64_t>(value));
+  }
+  return PyLong_FromUnsignedLongLong(value);
+}
+
+// Enumerators of an enum node, or nullptr with an exception set.
+auto enumerators(const DatabaseObject *db, const bin::Node &node)
+    -> const bin::Enumerator * {
+  const bin::Header &head = header(db);
+  if (!checked_range(node.first_child, node.child_count, head.enumerators)) {
+    return nullptr;
+  }
+  return table<bin::Enumerator>(db, head.enumerators) + node.first_child;
+}
+
+auto node_enumerators(NodeObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::Enum) {
+    return PyTuple_New(0);
+  }
+  if (enumerators(self->db, *node) == nullptr) {
+    return nullptr;
+  }
+  PyObject *tuple = PyTuple_New(node->child_count);
+  for (uint32_t i = 0; tuple != nullptr && i < node->child_count; ++i) {
+    PyObject *enumerator =
+        new_enumerator(self->db, node->first_child + i, self->index);
+    if (enumerator == nullptr) {
+      Py_CLEAR(tuple);
+      break;
+    }
+    PyTuple_SET_ITEM(tuple, i, enumerator);
+  }
+  return tuple;
+}
+
+// Binary search over the enum's value order, as EnumType::find_value.
+auto node_find_value(NodeObject *self, PyObject *value) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (!resolve(self, node)) {
+    return nullptr;
+  }
+  if (node->kind != bin::Kind::Enum) {
+    PyErr_SetString(PyExc_TypeError, "find_value() needs an enum node");
+    return nullptr;
+  }
+  bool is_signed = (node->flags & bin::kSigned) != 0;
+  uint64_t wanted = 0;
+  if (is_signed) {
+    long long parsed = PyLong_AsLongLong(value);
+    if (parsed == -1 && PyErr_Occurred() != nullptr) {
+      return nullptr;
+    }
+    wanted = static_cast<uint64_t>(parsed);
+  } else {
+    wanted = PyLong_AsUnsignedLongLong(value);
+    if (wanted == static_cast<uint64_t>(-1) && PyErr_Occurred() != nullptr) {
+      return nullptr;
+    }
+  }
+  const bin::Header &head = header(self->db);
+  const bin::Enumerator *values = enumerators(self->db, *node);
+  if (values == nullptr ||
+      !checked_range(node->first_extra, node->extra_count, head.indices)) {
+    return nullptr;
+  }
+  const uint32_t *order =
+      table<uint32_t>(self->db, head.indices) + node->first_extra;
+  const uint32_t *end = order + node->extra_count;
+  auto less = [&](uint64_t lhs, uint64_t rhs) {
+    return is_signed ? static_cast<int64_t>(lhs) < static_cast<int64_t>(rhs)
+                     : lhs < rhs;
+  };
+  const uint32_t *it =
+      std::lower_bound(order, end, wanted, [&](uint32_t index, uint64_t bound) {
+        return index < node->child_count && less(values[index].value, bound);
+      });
+  if (it == end || *it >= node->child_count || values[*it].value != wanted) {
+    Py_RETURN_NONE;
+  }
+  return new_str(self->db, values[*it].name);
+}
+
+auto node_repr(NodeObject *self) -> PyObject * {
+  const bin::Node *node = nullptr;
+  if (self->db->mapping.data == nullptr) {
+    return PyUnicode_FromFormat("<Node %u of a closed type db>", self->index);
+  }
+  resolve(self, node);
+  PyObject *name = new_str(self->db, node->name);
+  if (name == nullptr) {
+    return nullptr;
+  }
+  PyObject *repr = PyUnicode_FromFormat(
+      "<Node %u %s %R>", self->index,
+      kKindNames[static_cast<size_t>(node->kind)], name);
+  Py_DECREF(name);
+  return repr;
+}
+
+auto node_richcompare(PyObject *self, PyObject *other, int op) -> PyObject * {
+  if (!PyObject_TypeCheck(other, node_type) || (op != Py_EQ && op != Py_NE)) {
+    Py_RETURN_NOTIMPLEMENTED;
+  }
+  const auto *lhs = reinterpret_cast<const NodeObject *>(self);
+  const auto *rhs = reinterpret_cast<const NodeObject *>(other);
+  bool equal = lhs->db == rhs->db && lhs->index == rhs->index;
+  return PyBool_FromLong(equal == (op == Py_EQ) ? 1 : 0);
+}
+
+auto node_hash(NodeObject *self) -> Py_hash_t {
+  auto hash = static_cast<Py_hash_t>(
+      (reinterpret_cast<uintptr_t>(self->db) >> 4) * 1000003U ^ self->index);
+  return hash == -1 ? -2 : hash;
+}
+
+PyMethodDef node_methods[] = {
+    {"find_value", reinterpret_cast<PyCFunction>(node_find_value), METH_O,
+     "find_value(value) -> str | None\n\nName of the first enumerator with "
+     "this value."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef node_getset[] = {
+    {"index", reinterpret_cast<getter>(node_index), nullptr,
+     "Position in the db.", nullptr},
+    {"name", reinterpret_cast<getter>(node_name), nullptr, nullptr, nullptr},
+    {"cdecl", reinterpret_cast<getter>(node_cdecl), nullptr, nullptr,
+     nullptr},
+    {"kind", reinterpret_cast<getter>(node_kind), nullptr, nullptr, nullptr},
+    {"size_bytes", reinterpret_cast<getter>(node_size_bytes), nullptr,
+     "Object, enum and vftable size, else None.", nullptr},
+    {"align_bytes", reinterpret_cast<getter>(node_align_bytes), nullptr,
+     nullptr, nullptr},
+    {"size", reinterpret_cast<getter>(node_size), nullptr,
+     "Element count of a const_array.", nullptr},
+    {"spelling", reinterpret_cast<getter>(node_text), nullptr,
+     "Builtin, template parameter and template name, or unknown spelling.",
+     mask_closure(kind_bit(bin::Kind::Builtin) |
+                  kind_bit(bin::Kind::TemplateParam) |
+                  kind_bit(bin::Kind::TemplateSpecialization) |
+                  kind_bit(bin::Kind::Unknown))},
+    {"pointee", reinterpret_cast<getter>(node_text), nullptr, nullptr,
+     mask_closure(kind_bit(bin::Kind::Pointer))},
+    {"elem", reinterpret_cast<getter>(node_text), nullptr, nullptr,
+     mask_closure(kind_bit(bin::Kind::ConstArray) |
+                  kind_bit(bin::Kind::IncompleteArray))},
+    {"return_type", reinterpret_cast<getter>(node_text), nullptr, nullptr,
+     mask_closure(kind_bit(bin::Kind::Function))},
+    {"underlying_type", reinterpret_cast<getter>(node_text), nullptr, nullptr,
+     mask_closure(kind_bit(bin::Kind::Enum))},
+    {"original_record", reinterpret_cast<getter>(node_text), nullptr, nullptr,
+     mask_closure(kind_bit(bin::Kind::VfTable))},
+    {"primary_template", reinterpret_cast<getter>(node_text), nullptr,
+     nullptr, mask_closure(kind_bit(bin::Kind::Object))},
+    {"param_index", reinterpret_cast<getter>(node_param_index), nullptr,
+     "Index of a template_param.", nullptr},
+    {"param_depth", reinterpret_cast<getter>(node_param_depth), nullptr,
+     "Depth of a template_param.", nullptr},
+    {"variadic", reinterpret_cast<getter>(node_flag), nullptr, nullptr,
+     mask_closure(bin::kVariadic)},
+    {"template_primary", reinterpret_cast<getter>(node_flag), nullptr,
+     nullptr, mask_closure(bin::kTemplatePrimary)},
+    {"layout_dependent", reinterpret_cast<getter>(node_flag), nullptr,
+     nullptr, mask_closure(bin::kLayoutDependent)},
+    {"is_signed", reinterpret_cast<getter>(node_flag), nullptr, nullptr,
+     mask_closure(bin::kSigned)},
+    {"is_flags", reinterpret_cast<getter>(node_flag), nullptr, nullptr,
+     mask_closure(bin::kFlagsEnum)},
+    {"params", reinterpret_cast<getter>(node_child_strings), nullptr,
+     "Function parameter types.",
+     mask_closure(kind_bit(bin::Kind::Function))},
+    {"type_args", reinterpret_cast<getter>(node_child_strings), nullptr,
+     "Template specialization arguments.",
+     mask_closure(kind_bit(bin::Kind::TemplateSpecialization))},
+    {"template_type_args",
+     reinterpret_cast<getter>(node_template_type_args), nullptr, nullptr,
+     nullptr},
+    {"fields", reinterpret_cast<getter>(node_fields), nullptr,
+     "Fields of an object or slots of a vftable, as Field views.", nullptr},
+    {"enumerators", reinterpret_cast<getter>(node_enumerators), nullptr,
+     "Enumerator views in declaration order.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot node_slots[] = {
+    {Py_tp_doc, const_cast<char *>("View of one node of a Database.")},
+    {Py_tp_new, reinterpret_cast<void *>(view_new)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(node_repr)},
+    {Py_tp_richcompare, reinterpret_cast<void *>(node_richcompare)},
+    {Py_tp_hash, reinterpret_cast<void *>(node_hash)},
+    {Py_tp_methods, node_methods},
+    {Py_tp_getset, node_getset},
+    {0, nullptr},
+};
+
+auto resolve(const FieldObject *self, const bin::Field *&field) -> bool {
+  if (!check_open(self->db)) {
+    return false;
+  }
+  field = &field_at(self->db, self->index);
+  return true;
+}
+
+auto field_name(FieldObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Field *field = nullptr;
+  return resolve(self, field) ? new_str(self->db, field->name) : nullptr;
+}
+
+auto field_type_id(FieldObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Field *field = nullptr;
+  return resolve(self, field) ? new_str(self->db, field->type) : nullptr;
+}
+
+auto field_size_bytes(FieldObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Field *field = nullptr;
+  if (!resolve(self, field)) {
+    return nullptr;
+  }
+  return PyLong_FromUnsignedLongLong(field->size_bytes);
+}
+
+// Closure is the divisor applied to offset_bits: 1 for bits, 8 for bytes.
+auto field_offset(FieldObject *self, void *closure) -> PyObject * {
+  const bin::Field *field = nullptr;
+  if (!resolve(self, field)) {
+    return nullptr;
+  }
+  if ((field->flags & bin::kHasOffset) == 0) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(field->offset_bits /
+                                     closure_mask(closure));
+}
+
+auto field_bit_offset(FieldObject *self, void * /*closure*/) -> PyObject * {
+  constexpr uint64_t kBitsPerByte = 8;
+  const bin::Field *field = nullptr;
+  if (!resolve(self, field)) {
+    return nullptr;
+  }
+  if ((field->flags & bin::kHasOffset) == 0 ||
+      (field->flags & bin::kBitfield) == 0) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLongLong(field->offset_bits % kBitsPerByte);
+}
+
+auto field_bit_width(FieldObject *self, void * /*closure*/) -> PyObject * {
+  const bin::Field *field = nullptr;
+  if (!resolve(self, field)) {
+    return nullptr;
+  }
+  if ((field->flags & bin::kHasBitWidth) == 0) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromUnsignedLong(field->bit_width);
+}
+
+// Closure is a Field::flags bit.
+auto field_flag(FieldObject *self, void *closure) -> PyObject * {
+  const bin::Field *field = nullptr;
+  if (!resolve(self, field)) {
+    return nullptr;
+  }
+  return PyBool_FromLong((field->flags & closure_mask(closure)) != 0 ? 1 : 0);
+}
+
+auto field_repr(FieldObject *self) -> PyObject * {
+  const bin::Field *field = nullptr;
+  if (self->db->mapping.data == nullptr) {
+    return PyUnicode_FromFormat("<Field %u of a closed type db>", self->index);
+  }
+  resolve(self, field);
+  PyObject *name = new_str(self->db, field->name);
+  PyObject *type = name != nullptr ? new_str(self->db, field->type) : nullptr;
+  PyObject *repr =
+      type != nullptr ? PyUnicode_FromFormat("<Field %R: %R>", name, type)
+                      : nullptr;
+  Py_XDECREF(name);
+  Py_XDECREF(type);
+  return repr;
+}
+
+PyGetSetDef field_getset[] = {
+    {"name", reinterpret_cast<getter>(field_name), nullptr, nullptr,
+     nullptr},
+    {"type", reinterpret_cast<getter>(field_type_id), nullptr, nullptr,
+     nullptr},
+    {"size_bytes", reinterpret_cast<getter>(field_size_bytes), nullptr,
+     nullptr, nullptr},
+    {"offset_bits", reinterpret_cast<getter>(field_offset), nullptr, nullptr,
+     mask_closure(1)},
+    {"offset_bytes", reinterpret_cast<getter>(field_offset), nullptr, nullptr,
+     mask_closure(8)},
+    {"bit_offset", reinterpret_cast<getter>(field_bit_offset), nullptr,
+     "Bit position within offset_bytes, for bitfields.", nullptr},
+    {"bit_width", reinterpret_cast<getter>(field_bit_width), nullptr, nullptr,
+     nullptr},
+    {"is_base", reinterpret_cast<getter>(field_flag), nullptr, nullptr,
+     mask_closure(bin::kBase)},
+    {"is_virtual_base", reinterpret_cast<getter>(field_flag), nullptr,
+     nullptr, mask_closure(bin::kVirtualBase)},
+    {"is_vfptr", reinterpret_cast<getter>(field_flag), nullptr, nullptr,
+     mask_closure(bin::kVfPtr)},
+    {"is_bitfield", reinterpret_cast<getter>(field_flag), nullptr, nullptr,
+     mask_closure(bin::kBitfield)},
+    {"layout_known", reinterpret_cast<getter>(field_flag), nullptr, nullptr,
+     mask_closure(bin::kLayoutKnown)},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot field_slots[] = {
+    {Py_tp_doc, const_cast<char *>("View of one field of a Node.")},
+    {Py_tp_new, reinterpret_cast<void *>(view_new)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(field_repr)},
+    {Py_tp_getset, field_getset},
+    {0, nullptr},
+};
+
+auto resolve(const EnumeratorObject *self, const bin::Enumerator *&enumerator)
+    -> bool {
+  if (!check_open(self->db)) {
+    return false;
+  }
+  enumerator = &enumerator_at(self->db, self->index);
+  return true;
+}
+
+auto enumerator_name(EnumeratorObject *self, void * /*closure*/)
+    -> PyObject * {
+  const bin::Enumerator *enumerator = nullptr;
+  return resolve(self, enumerator) ? new_str(self->db, enumerator->name)
+                                   : nullptr;
+}
+
+auto enumerator_value(EnumeratorObject *self, void * /*closure*/)
+    -> PyObject * {
+  const bin::Enumerator *enumerator = nullptr;
+  if (!resolve(self, enumerator)) {
+    return nullptr;
+  }
+  return enum_value(node_at(self->db, self->node), enumerator->value);
+}
+
+// An Enumerator unpacks as the (name, value) pair it replaced.
+auto enumerator_length(EnumeratorObject * /*self*/) -> Py_ssize_t {
+  return 2;
+}
+
+auto enumerator_item(EnumeratorObject *self, Py_ssize_t index) -> PyObject * {
+  switch (index) {
+  case 0:
+    return enumerator_name(self, nullptr);
+  case 1:
+    return enumerator_value(self, nullptr);
+  default:
+    PyErr_SetString(PyExc_IndexError, "Enumerator index out of range");
+    return nullptr;
+  }
+}
+
+auto enumerator_repr(EnumeratorObject *self) -> PyObject * {
+  if (self->db->mapping.data == nullptr) {
+    return PyUnicode_FromFormat("<Enumerator %u of a closed type db>",
+                                self->index);
+  }
+  PyObject *name = enumerator_name(self, nullptr);
+  PyObject *value = name != nullptr ? enumerator_value(self, nullptr)
+                                    : nullptr;
+  PyObject *repr = value != nullptr
+                       ? PyUnicode_FromFormat("<Enumerator %R = %R>", name,
+                                              value)
+                       : nullptr;
+  Py_XDECREF(name);
+  Py_XDECREF(value);
+  return repr;
+}
+
+PyGetSetDef enumerator_getset[] = {
+    {"name", reinterpret_cast<getter>(enumerator_name), nullptr, nullptr,
+     nullptr},
+    {"value", reinterpret_cast<getter>(enumerator_value), nullptr,
+     "Negative only for signed enums.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot enumerator_slots[] = {
+    {Py_tp_doc, const_cast<char *>("View of one enumerator of a Node.")},
+    {Py_tp_new, reinterpret_cast<void *>(view_new)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(enumerator_repr)},
+    {Py_tp_getset, enumerator_getset},
+    {Py_sq_length, reinterpret_cast<void *>(enumerator_length)},
+    {Py_sq_item, reinterpret_cast<void *>(enumerator_item)},
+    {0, nullptr},
+};
+
+void node_list_dealloc(NodeListObject *self) {
+  delete self->indices;
+  Py_XDECREF(self->db);
+  PyTypeObject *type = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(type);
+}
+
+auto node_list_length(NodeListObject *self) -> Py_ssize_t {
+  return self->length;
+}
+
+auto node_list_item(NodeListObject *self, Py_ssize_t index) -> PyObject * {
+  if (index < 0 || index >= node_list_length(self)) {
+    PyErr_SetString(PyExc_IndexError, "NodeList index out of range");
+    return nullptr;
+  }
+  if (!check_open(self->db)) {
+    return nullptr;
+  }
+  return new_node(self->db, (*self->indices)[static_cast<size_t>(index)]);
+}
+
+auto node_list_getbuffer(NodeListObject *self, Py_buffer *view, int flags)
+    -> int {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "NodeList is read-only");
+    view->obj = nullptr;
+    return -1;
+  }
+  static char format[] = "I";
+  Py_INCREF(self);
+  view->obj = reinterpret_cast<PyObject *>(self);
+  view->buf = self->indices->data();
+  view->len = static_cast<Py_ssize_t>(self->indices->size() *
+                                      sizeof(uint32_t));
+  view->readonly = 1;
+  view->itemsize = sizeof(uint32_t);
+  view->format = (flags & PyBUF_FORMAT) != 0 ? format : nullptr;
+  view->ndim = 1;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &self->length : nullptr;
+  view->strides =
+      (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &view->itemsize : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+auto node_list_repr(NodeListObject *self) -> PyObject * {
+  return PyUnicode_FromFormat("<NodeList of %zd nodes>",
+                              node_list_length(self));
+}
+
+PyType_Slot node_list_slots[] = {
+    {Py_tp_doc,
+     const_cast<char *>(
+         "Result of a Database query. Items are created on access; the "
+         "buffer protocol exposes the matching node indices as uint32.")},
+    {Py_tp_new, reinterpret_cast<void *>(view_new)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(node_list_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(node_list_repr)},
+    {Py_sq_length, reinterpret_cast<void *>(node_list_length)},
+    {Py_sq_item, reinterpret_cast<void *>(node_list_item)},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(node_list_getbuffer)},
+    {0, nullptr},
+};
+
+PyType_Spec database_spec = {"me3_typedb.Database", sizeof(DatabaseObject),
+                             0, Py_TPFLAGS_DEFAULT, database_slots};
+
+PyType_Spec node_spec = {"me3_typedb.Node", sizeof(NodeObject), 0,
+                         Py_TPFLAGS_DEFAULT, node_slots};
+PyType_Spec field_spec = {"me3_typedb.Field", sizeof(FieldObject), 0,
+                          Py_TPFLAGS_DEFAULT, field_slots};
+PyType_Spec enumerator_spec = {"me3_typedb.Enumerator",
+                               sizeof(EnumeratorObject), 0,
+                               Py_TPFLAGS_DEFAULT, enumerator_slots};
+PyType_Spec node_list_spec = {"me3_typedb.NodeList", sizeof(NodeListObject),
+                              0, Py_TPFLAGS_DEFAULT, node_list_slots};
+
+auto module_open(PyObject * /*module*/, PyObject *path) -> PyObject * {
+  return PyObject_CallOneArg(reinterpret_cast<PyObject *>(database_type),
+                             path);
+}
+
+PyMethodDef module_methods[] = {
+    {"open", module_open, METH_O,
+     "open(path) -> Database\n\nMaps a file written with --emit-binary."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "me3_typedb",
+    "Zero-copy access to binary type dbs written by me3-typedb-parser.",
+    -1,
+    module_methods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+auto add_type(PyObject *module, PyType_Spec &spec, PyTypeObject *&type)
+    -> bool {
+  type = reinterpret_cast<PyTypeObject *>(PyType_FromSpec(&spec));
+  if (type == nullptr) {
+    return false;
+  }
+  const char *name = std::strrchr(spec.name, '.') + 1;
+  Py_INCREF(type);
+  if (PyModule_AddObject(module, name, reinterpret_cast<PyObject *>(type)) !=
+      0) {
+    Py_DECREF(type);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_me3_typedb() {
+  PyObject *module = PyModule_Create(&module_def);
+  if (module == nullptr) {
+    return nullptr;
+  }
+  if (!add_type(module, database_spec, database_type) ||
+      !add_type(module, node_spec, node_type) ||
+      !add_type(module, field_spec, field_type) ||
+      !add_type(module, enumerator_spec, enumerator_type) ||
+      !add_type(module, node_list_spec, node_list_type) ||
+      PyModule_AddIntConstant(module, "FORMAT_VERSION", bin::kVersion) != 0) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
@@ -0,0 +1,192 @@
+"""Reads the fixture written by `typedb_binary_test <path>` through the
+me3_typedb extension.
+
+Usage: typedb_python_test.py <typedb_binary_test> [unittest args...]
+"""
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import me3_typedb
+
+WRITER = None
+
+# Header offset of the nodes section, and the offset of Node::kind within a
+# node record; see typedb_binary_format.h.
+NODES_SECTION = 48
+NODE_KIND = 16
+
+
+def write_fixture(path):
+    subprocess.run([WRITER, path], check=True)
+
+
+class TypeDbTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.dir = tempfile.TemporaryDirectory()
+        cls.path = os.path.join(cls.dir.name, "types.bin")
+        write_fixture(cls.path)
+        cls.db = me3_typedb.open(cls.path)
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.db.close()
+        cls.dir.cleanup()
+
+    def corrupt(self, edit):
+        with open(self.path, "rb") as source:
+            data = bytearray(source.read())
+        edit(data)
+        path = os.path.join(self.dir.name, "corrupt.bin")
+        with open(path, "wb") as out:
+            out.write(data)
+        return path
+
+    def test_header(self):
+        self.assertEqual(self.db.triple, "x86_64-pc-windows-msvc")
+        self.assertEqual(self.db.pointer_width_bits, 64)
+        self.assertEqual(self.db.char_width_bits, 8)
+        self.assertEqual(self.db.long_width_bits, 32)
+        self.assertEqual(len(self.db), 12)
+
+    def test_every_kind(self):
+        self.assertEqual(
+            [node.kind for node in self.db],
+            ["builtin", "template_param", "pointer", "const_array",
+             "incomplete_array", "function", "template_specialization",
+             "object", "enum", "enum", "vftable", "unknown"])
+        db = self.db
+        self.assertEqual(db["int"].spelling, "int")
+        self.assertEqual((db["T"].param_index, db["T"].param_depth), (1, 2))
+        self.assertEqual(db["int *"].pointee, "int")
+        self.assertEqual((db["int[4]"].elem, db["int[4]"].size), ("int", 4))
+        self.assertEqual(db["int[]"].elem, "int")
+        function = db["void (int, ...)"]
+        self.assertEqual(function.return_type, "void")
+        self.assertEqual(function.params, ("int",))
+        self.assertTrue(function.variadic)
+        self.assertEqual(db["Box<T>"].spelling, "Box")
+        self.assertEqual(db["Box<T>"].type_args, ("T",))
+        record = db["Box<int>"]
+        self.assertEqual((record.size_bytes, record.align_bytes), (16, 8))
+        self.assertEqual(record.primary_template, "Box")
+        self.assertEqual(record.template_type_args, ("int",))
+        table = db["Box<int>::vftable"]
+        self.assertEqual(table.original_record, "Box<int>")
+        self.assertEqual([slot.name for slot in table.fields], ["~Box", "get"])
+        self.assertEqual(db["decltype(auto)"].spelling, "decltype(auto)")
+        self.assertIsNone(db["int *"].size_bytes)
+
+    def test_fields(self):
+        vfptr, count, bits, value = self.db["Box<int>"].fields
+        self.assertTrue(vfptr.is_vfptr)
+        self.assertEqual((count.type, count.offset_bytes), ("int", 8))
+        self.assertIsNone(count.bit_offset)
+        self.assertTrue(bits.is_bitfield)
+        self.assertEqual(bits.offset_bits, 99)
+        self.assertEqual(bits.offset_bytes, 12)
+        self.assertEqual(bits.bit_offset, 3)
+        self.assertEqual(bits.bit_width, 5)
+        self.assertIsNone(value.offset_bits)
+        self.assertFalse(value.layout_known)
+
+    def test_signed_enum(self):
+        node = self.db["Signed"]
+        self.assertTrue(node.is_signed)
+        self.assertEqual(node.find_value(-1), "Neg")
+        self.assertEqual(node.find_value(-2**63), "Min")
+        self.assertEqual(node.find_value(0), "Zero")
+        self.assertIsNone(node.find_value(1))
+        self.assertEqual([(e.name, e.value) for e in node.enumerators],
+                         [("Zero", 0), ("Min", -2**63), ("Neg", -1)])
+
+    def test_unsigned_enum(self):
+        node = self.db["Unsigned"]
+        self.assertFalse(node.is_signed)
+        self.assertEqual(node.find_value(2**64 - 1), "Max")
+        self.assertEqual(node.find_value(2**63), "High")
+        self.assertEqual(node.find_value(1), "One")
+        self.assertIsNone(node.find_value(2))
+        with self.assertRaises(OverflowError):
+            node.find_value(-1)
+        # Enumerators still unpack as (name, value) pairs.
+        self.assertEqual([tuple(e) for e in node.enumerators],
+                         [("Max", 2**64 - 1), ("One", 1), ("High", 2**63)])
+        with self.assertRaises(TypeError):
+            self.db["int"].find_value(0)
+
+    def test_name_lookup(self):
+        for node in self.db:
+            self.assertEqual(self.db[node.name], node)
+            self.assertIn(node.name, self.db)
+        self.assertEqual(self.db.find("Unsigned").index, 9)
+        self.assertIsNone(self.db.find("Missing"))
+        self.assertNotIn("Box", self.db)
+        with self.assertRaises(KeyError):
+            self.db["Missing"]
+
+    def test_select(self):
+        enums = self.db.nodes_of_kind("enum")
+        self.assertEqual([node.name for node in enums], ["Signed", "Unsigned"])
+        self.assertEqual(memoryview(enums).tolist(), [8, 9])
+        self.assertEqual(len(self.db.structs_larger_than(8)), 1)
+        self.assertEqual(
+            [node.name for node in self.db.select(prefix="Box<int>")],
+            ["Box<int>", "Box<int>::vftable"])
+        with self.assertRaises(ValueError):
+            self.db.nodes_of_kind("struct")
+
+    def test_views_are_not_instantiable(self):
+        for view in (me3_typedb.Node, me3_typedb.Field,
+                     me3_typedb.Enumerator, me3_typedb.NodeList):
+            with self.assertRaises(TypeError):
+                view()
+
+    def test_closed(self):
+        db = me3_typedb.open(self.path)
+        node = db["Signed"]
+        enumerator = node.enumerators[0]
+        db.close()
+        self.assertTrue(db.closed)
+        with self.assertRaises(ValueError):
+            node.name
+        with self.assertRaises(ValueError):
+            enumerator.value
+
+    def test_rejects_truncated(self):
+        size = os.path.getsize(self.path)
+        for keep in (16, size - 8):
+            path = self.corrupt(lambda data: data.__delitem__(
+                slice(keep, None)))
+            with self.assertRaisesRegex(ValueError, "truncated|not a binary"):
+                me3_typedb.open(path)
+
+    def test_rejects_corrupt(self):
+        def bad_magic(data):
+            data[0:3] = b"XXX"
+
+        def bad_version(data):
+            struct.pack_into("<I", data, 8, 99)
+
+        def bad_kind(data):
+            (nodes,) = struct.unpack_from("<Q", data, NODES_SECTION)
+            data[nodes + NODE_KIND] = 200
+
+        def bad_count(data):
+            struct.pack_into("<Q", data, NODES_SECTION + 8, 2**40)
+
+        for edit, message in ((bad_magic, "not a binary type db"),
+                              (bad_version, "version 99"),
+                              (bad_kind, "unknown kind 200"),
+                              (bad_count, "truncated or corrupt")):
+            with self.assertRaisesRegex(ValueError, message):
+                me3_typedb.open(self.corrupt(edit))
+
+
+if __name__ == "__main__":
+    WRITER = sys.argv.pop(1)
+    unittest.main()
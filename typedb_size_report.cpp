@@ -0,0 +1,221 @@
+#include "typedb_size_report.h"
+#include <algorithm>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <string_view>
+#include <vector>
+
+namespace me3::typedb {
+namespace {
+
+// Names as they appear in the serialized "kind" attribute, in NodeVariant
+// order.
+constexpr std::array<const char *, std::variant_size_v<NodeVariant>>
+    kKindNames = {"builtin",
+                  "template_param",
+                  "pointer",
+                  "const_array",
+                  "incomplete_array",
+                  "function",
+                  "template_specialization",
+                  "object",
+                  "enum",
+                  "vftable",
+                  "unknown"};
+
+// Counts bytes without storing them.
+class CountingStream : public llvm::raw_ostream {
+public:
+  CountingStream() { SetUnbuffered(); }
+
+  [[nodiscard]] auto count() const -> uint64_t { return count_; }
+
+private:
+  void write_impl(const char * /*ptr*/, size_t size) override {
+    count_ += size;
+  }
+  [[nodiscard]] auto current_pos() const -> uint64_t override {
+    return count_;
+  }
+
+  uint64_t count_ = 0;
+};
+
+auto string_heap(const std::string &value) -> uint64_t {
+  static const size_t kInlineCapacity = std::string().capacity();
+  return value.capacity() > kInlineCapacity ? value.capacity() + 1 : 0;
+}
+
+template <typename T>
+auto buffer_heap(const std::vector<T> &values) -> uint64_t {
+  return values.capacity() * sizeof(T);
+}
+
+auto strings_heap(const std::vector<std::string> &values) -> uint64_t {
+  uint64_t bytes = buffer_heap(values);
+  for (const std::string &value : values) {
+    bytes += string_heap(value);
+  }
+  return bytes;
+}
+
+auto fields_heap(const std::vector<ObjectField> &fields) -> uint64_t {
+  uint64_t bytes = buffer_heap(fields);
+  for (const ObjectField &field : fields) {
+    bytes += string_heap(field.name) + string_heap(field.type_id);
+  }
+  return bytes;
+}
+
+// Heap owned by a node's payload, and its number of child entries.
+struct PayloadSize {
+  uint64_t heap_bytes = 0;
+  uint64_t children = 0;
+};
+
+struct PayloadSizeVisitor {
+  auto operator()(const BuiltinType &value) const -> PayloadSize {
+    return {string_heap(value.name), 0};
+  }
+  auto operator()(const TemplateParameterType &value) const -> PayloadSize {
+    return {string_heap(value.name), 0};
+  }
+  auto operator()(const PointerType &value) const -> PayloadSize {
+    return {string_heap(value.pointee), 0};
+  }
+  auto operator()(const FixedSizeArrayType &value) const -> PayloadSize {
+    return {string_heap(value.elem), 0};
+  }
+  auto operator()(const UnsizedArrayType &value) const -> PayloadSize {
+    return {string_heap(value.elem), 0};
+  }
+  auto operator()(const FunctionType &value) const -> PayloadSize {
+    return {string_heap(value.return_type) + strings_heap(value.params),
+            value.params.size()};
+  }
+  auto operator()(const TemplateSpecializationType &value) const
+      -> PayloadSize {
+    return {string_heap(value.name) + strings_heap(value.type_args),
+            value.type_args.size()};
+  }
+  auto operator()(const ObjectType &value) const -> PayloadSize {
+    uint64_t bytes =
+        strings_heap(value.template_type_args) + fields_heap(value.fields);
+    if (value.primary_template) {
+      bytes += string_heap(*value.primary_template);
+    }
+    return {bytes, value.fields.size() + value.template_type_args.size()};
+  }
+  auto operator()(const EnumType &value) const -> PayloadSize {
+    uint64_t bytes = string_heap(value.underlying_type) +
+                     buffer_heap(value.enumerators) +
+                     buffer_heap(value.value_order);
+    for (const Enumerator &enumerator : value.enumerators) {
+      bytes += string_heap(enumerator.name);
+    }
+    return {bytes, value.enumerators.size()};
+  }
+  auto operator()(const VfTableType &value) const -> PayloadSize {
+    return {string_heap(value.original_record) + fields_heap(value.fields),
+            value.fields.size()};
+  }
+  auto operator()(const UnknownType &value) const -> PayloadSize {
+    return {string_heap(value.spelling), 0};
+  }
+};
+
+// First component of a qualified type id, ignoring leading qualifiers.
+auto top_level_namespace(std::string_view name) -> std::string {
+  constexpr std::string_view kAnonymous = "(anonymous namespace)";
+  for (std::string_view prefix :
+       {"const ", "volatile ", "struct ", "class ", "union ", "enum "}) {
+    if (name.starts_with(prefix)) {
+      name.remove_prefix(prefix.size());
+    }
+  }
+  if (name.starts_with(kAnonymous)) {
+    return std::string(kAnonymous);
+  }
+  size_t length = 0;
+  while (length < name.size() &&
+         (llvm::isAlnum(name[length]) || name[length] == '_')) {
+    ++length;
+  }
+  if (length == 0 || !name.substr(length).starts_with("::")) {
+    return "(global)";
+  }
+  return std::string(name.substr(0, length));
+}
+
+constexpr const char *kRowFormat = "{0,-32} {1,10} {2,10} {3,14} {4,14}\n";
+
+void write_row(llvm::raw_ostream &out, llvm::StringRef label,
+               const SizeStats &stats) {
+  out << llvm::formatv(kRowFormat, label, stats.nodes, stats.children,
+                       stats.heap_bytes, stats.serialized_bytes);
+}
+
+void write_header(llvm::raw_ostream &out, llvm::StringRef label) {
+  out << llvm::formatv(kRowFormat, label, "nodes", "children", "heap bytes",
+                       "json bytes");
+}
+
+} // namespace
+
+auto build_size_report(const TypeDb &type_db, const JsonOptions &options)
+    -> SizeReport {
+  SizeReport report;
+  type_db.for_each_node([&](const std::string &name, const std::string &cdecl,
+                            const auto &data) {
+    using Kind = std::decay_t<decltype(data)>;
+    PayloadSize payload = PayloadSizeVisitor{}(data);
+    SizeStats stats;
+    stats.nodes = 1;
+    stats.children = payload.children;
+    stats.heap_bytes = payload.heap_bytes + string_heap(name) +
+                       string_heap(cdecl) +
+                       (type_db.is_columnar()
+                            ? sizeof(Kind) + 2 * sizeof(std::string) +
+                                  sizeof(NodeSlot)
+                            : sizeof(Node));
+
+    CountingStream counter;
+    counter << llvm::json::Value(name) << ':'
+            << llvm::json::Value(node_json(name, cdecl, data, options))
+            << ',';
+    stats.serialized_bytes = counter.count();
+
+    report.by_kind[node_kind_index_v<Kind>].add(stats);
+    report.by_namespace[top_level_namespace(name)].add(stats);
+    report.total.add(stats);
+  });
+  return report;
+}
+
+void write_size_report(const SizeReport &report, llvm::raw_ostream &out) {
+  write_header(out, "kind");
+  for (size_t kind = 0; kind < report.by_kind.size(); ++kind) {
+    write_row(out, kKindNames[kind], report.by_kind[kind]);
+  }
+  write_row(out, "total", report.total);
+  out << "\n";
+
+  // Largest namespaces first.
+  std::vector<const std::pair<const std::string, SizeStats> *> namespaces;
+  namespaces.reserve(report.by_namespace.size());
+  for (const auto &entry : report.by_namespace) {
+    namespaces.push_back(&entry);
+  }
+  std::stable_sort(namespaces.begin(), namespaces.end(),
+                   [](const auto *lhs, const auto *rhs) {
+                     return lhs->second.heap_bytes > rhs->second.heap_bytes;
+                   });
+  write_header(out, "namespace");
+  for (const auto *entry : namespaces) {
+    write_row(out, entry->first, entry->second);
+  }
+}
+
+} // namespace me3::typedb
@@ -0,0 +1,46 @@
+#pragma once
+#include "typedb.h"
+#include "typedb_json.h"
+#include <array>
+#include <cstdint>
+#include <llvm/Support/raw_ostream.h>
+#include <map>
+#include <string>
+#include <variant>
+
+namespace me3::typedb {
+
+struct SizeStats {
+  uint64_t nodes = 0;
+  // Fields, params, type args and enumerators held by the nodes.
+  uint64_t children = 0;
+  // Estimated heap footprint: the node's own slot in TypeDb storage plus
+  // every string and vector buffer it owns. Excludes node_index.
+  uint64_t heap_bytes = 0;
+  // Compact JSON size of the node's "name": payload entry.
+  uint64_t serialized_bytes = 0;
+
+  void add(const SizeStats &other) {
+    nodes += other.nodes;
+    children += other.children;
+    heap_bytes += other.heap_bytes;
+    serialized_bytes += other.serialized_bytes;
+  }
+};
+
+struct SizeReport {
+  // Indexed like NodeVariant.
+  std::array<SizeStats, std::variant_size_v<NodeVariant>> by_kind;
+  // Keyed by the first component of the node name, e.g. "std"; names
+  // without a namespace are grouped under "(global)".
+  std::map<std::string, SizeStats> by_namespace;
+  SizeStats total;
+};
+
+auto build_size_report(const TypeDb &type_db, const JsonOptions &options = {})
+    -> SizeReport;
+
+// Writes both breakdowns as aligned text tables.
+void write_size_report(const SizeReport &report, llvm::raw_ostream &out);
+
+} // namespace me3::typedb
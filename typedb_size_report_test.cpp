@@ -0,0 +1,118 @@
+#include "typedb.h"
+#include "typedb_json.h"
+#include "typedb_size_report.h"
+#include "typedb_test.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <utility>
+
+using namespace me3::typedb;
+
+namespace {
+
+void add_node(TypeDb &db, std::string name, NodeVariant data) {
+  Node node;
+  node.name = std::move(name);
+  node.data = std::move(data);
+  db.nodes.push_back(std::move(node));
+}
+
+auto sample_db() -> TypeDb {
+  TypeDb db;
+  add_node(db, "int", BuiltinType{"int"});
+  add_node(db, "const std::basic_string<char> *",
+           PointerType{"const std::basic_string<char>"});
+  ObjectType string;
+  string.size_bytes = 32;
+  string.fields.resize(3);
+  string.template_type_args = {"char"};
+  add_node(db, "std::basic_string<char>", std::move(string));
+  add_node(db, "(anonymous namespace)::Local", ObjectType{});
+  EnumType color;
+  color.enumerators = {{"Red", 0}, {"Green", 1}};
+  color.build_value_order();
+  add_node(db, "enum Color", std::move(color));
+  add_node(db, "game::ui::Widget",
+           FunctionType{.return_type = "void", .params = {"int", "int"}});
+  db.build_indices();
+  return db;
+}
+
+void test_breakdowns() {
+  SizeReport report = build_size_report(sample_db());
+  TYPEDB_CHECK_EQ(report.total.nodes, uint64_t{6});
+  TYPEDB_CHECK_EQ(report.total.children, uint64_t{3 + 1 + 2 + 2});
+  TYPEDB_CHECK_EQ(report.by_kind[node_kind_index_v<ObjectType>].nodes,
+                  uint64_t{2});
+  TYPEDB_CHECK_EQ(report.by_kind[node_kind_index_v<ObjectType>].children,
+                  uint64_t{4});
+  TYPEDB_CHECK_EQ(report.by_kind[node_kind_index_v<EnumType>].children,
+                  uint64_t{2});
+  TYPEDB_CHECK_EQ(report.by_kind[node_kind_index_v<VfTableType>].nodes,
+                  uint64_t{0});
+
+  TYPEDB_CHECK_EQ(report.by_namespace.size(), size_t{4});
+  TYPEDB_CHECK_EQ(report.by_namespace["std"].nodes, uint64_t{2});
+  TYPEDB_CHECK_EQ(report.by_namespace["(global)"].nodes, uint64_t{2});
+  TYPEDB_CHECK_EQ(report.by_namespace["(anonymous namespace)"].nodes,
+                  uint64_t{1});
+  TYPEDB_CHECK_EQ(report.by_namespace["game"].nodes, uint64_t{1});
+
+  SizeStats summed;
+  for (const SizeStats &stats : report.by_kind) {
+    summed.add(stats);
+  }
+  TYPEDB_CHECK_EQ(summed.heap_bytes, report.total.heap_bytes);
+  TYPEDB_CHECK_EQ(summed.serialized_bytes, report.total.serialized_bytes);
+  TYPEDB_CHECK(report.total.heap_bytes >= 6 * sizeof(Node));
+}
+
+void test_serialized_bytes() {
+  // Each node counts as `"name":payload,` in compact JSON, so the total is
+  // the compact "nodes" object minus its braces, plus one comma.
+  TypeDb db = sample_db();
+  for (bool legacy : {false, true}) {
+    JsonOptions options{.legacy_schema = legacy};
+    llvm::json::Value json = typedb_to_json(db, options);
+    std::string nodes =
+        llvm::formatv("{0}", *json.getAsObject()->get("nodes")).str();
+    SizeReport report = build_size_report(db, options);
+    TYPEDB_CHECK_EQ(report.total.serialized_bytes, uint64_t{nodes.size() - 1});
+  }
+
+  // Columnar storage changes the heap estimate, not the counts.
+  SizeReport rows = build_size_report(db);
+  db.columnize();
+  SizeReport columns = build_size_report(db);
+  TYPEDB_CHECK_EQ(columns.total.nodes, rows.total.nodes);
+  TYPEDB_CHECK_EQ(columns.total.children, rows.total.children);
+  TYPEDB_CHECK_EQ(columns.total.serialized_bytes,
+                  rows.total.serialized_bytes);
+}
+
+void test_table() {
+  std::string text;
+  llvm::raw_string_ostream out(text);
+  write_size_report(build_size_report(sample_db()), out);
+  llvm::StringRef table(out.str());
+  TYPEDB_CHECK(table.startswith("kind "));
+  TYPEDB_CHECK(table.contains("\nobject "));
+  TYPEDB_CHECK(table.contains("\ntotal "));
+  TYPEDB_CHECK(table.contains("\nnamespace "));
+  // Namespaces are listed largest first; std holds the string record.
+  size_t table_start = table.find("\nnamespace ");
+  TYPEDB_CHECK(table.find("\nstd ", table_start) <
+               table.find("\n(global) ", table_start));
+}
+
+} // namespace
+
+auto main() -> int {
+  test_breakdowns();
+  test_serialized_bytes();
+  test_table();
+  return me3::typedb::test::test_result();
+}
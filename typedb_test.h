@@ -0,0 +1,48 @@
+#pragma once
+// Assertions for the typedb_*_test executables. Each test is a plain program
+// registered with ctest; failed checks are printed and reflected in the exit
+// status returned by test_result().
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+
+namespace me3::typedb::test {
+
+inline unsigned failures = 0;
+
+inline void report_failure(const char *file, int line,
+                           const std::string &what) {
+  llvm::errs() << file << ":" << line << ": check failed: " << what << "\n";
+  ++failures;
+}
+
+inline auto test_result() -> int {
+  if (failures != 0) {
+    llvm::errs() << failures << " check(s) failed\n";
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace me3::typedb::test
+
+#define TYPEDB_CHECK(condition)                                                \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      ::me3::typedb::test::report_failure(__FILE__, __LINE__, #condition);     \
+    }                                                                          \
+  } while (false)
+
+// Operands must be printable with llvm::raw_ostream.
+#define TYPEDB_CHECK_EQ(actual, expected)                                      \
+  do {                                                                         \
+    const auto &typedb_actual = (actual);                                      \
+    const auto &typedb_expected = (expected);                                  \
+    if (!(typedb_actual == typedb_expected)) {                                 \
+      std::string typedb_message;                                              \
+      llvm::raw_string_ostream typedb_stream(typedb_message);                  \
+      typedb_stream << #actual " == " #expected " (got " << typedb_actual     \
+                    << ", expected " << typedb_expected << ")";                \
+      ::me3::typedb::test::report_failure(__FILE__, __LINE__,                  \
+                                          typedb_stream.str());                \
+    }                                                                          \
+  } while (false)